@@ -55,49 +55,126 @@
 #define swap(type, i, j) {type t = i; i = j; j = t;}
 #define fontbyte(x) pgm_read_byte(&cfont.font[x])  
 
+// Entry mode set by InitLCD, pixels stream along display rows in either orientation
+#define ENTRY_MODE(O) (0x6040|ID1|ID0|((O)==LANDSCAPE ? AM : 0))
 
-UTFT::UTFT()
+
+UTFTBase::UTFTBase()
 { 
-disp_x_size=239;
-disp_y_size=319;
-SSD1289_init();	
+// a panel still set up from before an MCU reset keeps its picture
+warm=SSD1289_ready();
+if (warm)
+	device_id=SSD1289_ID;
+else
+{
+	// one more reset for a panel that was slow to power up
+	device_id=SSD1289_init();
+	if (device_id!=SSD1289_ID)
+		device_id=SSD1289_init();
+}
+clip_x1=0;
+clip_y1=0;
+clip_x2=disp_x_size;
+clip_y2=disp_y_size;
+scroll_first=0;
+scroll_last=disp_y_size;
+scroll_offset=0;
+scroll_reg=0x41;
 }
 
-void UTFT::InitLCD(byte orientation)
+void UTFTBase::InitLCD(byte orientation)
 {
-	orient=orientation;
+	word r01 = SSD1289_R01;
+	
+	// 90 degrees is a mirror of the gate scan on top of the axis swap,
+	// 180 degrees mirrors both the source and the gate scan.
+	if (orientation==PORTRAIT || orientation==LANDSCAPE_FLIPPED)
+		r01 |= TB;
+	if (orientation==PORTRAIT_FLIPPED || orientation==LANDSCAPE_FLIPPED)
+		r01 |= RL;
+	
+	cbi(CS_PORT, CS_PIN);
+	SSD1289_writeMask(0, 0);
+	SSD1289_reg01(r01);
+	if (orientation & LANDSCAPE)
+	{
+		SSD1289_reg11(ENTRY_MODE(LANDSCAPE));
+	}
+	else
+	{
+		SSD1289_reg11(ENTRY_MODE(PORTRAIT));
+	}
+	sbi(CS_PORT, CS_PIN);
+	
+	// undo scrolling or a split screen a warm start may have left behind
+	clrSplitScreen();
+
+	if (orientation & LANDSCAPE)
+		clrClipRect<LANDSCAPE>();
+	else
+		clrClipRect<PORTRAIT>();
+
 	setColor(255, 255, 255);
 	setBackColor(0, 0, 0);
 	cfont.font=0;	
 }
 
-void UTFT::setXY(word x1, word y1, word x2, word y2)
+template <byte O>
+void UTFTBase::setXY(word x1, word y1, word x2, word y2)
+{
+	setXY<O>(x1, y1, x2, y2, ENTRY_MODE(O));
+}
+
+// Window, cursor at its start and entry mode in one LCD_Prepare_GRAM call
+template <byte O>
+void UTFTBase::setXY(word x1, word y1, word x2, word y2, word mode)
 {
-	if (orient==LANDSCAPE)
+	if (O==LANDSCAPE)
 	{
 		swap(word, x1, y1);
-		swap(word, x2, y2)
-		y1=disp_y_size-y1;
-		y2=disp_y_size-y2;
-		swap(word, y1, y2)
+		swap(word, x2, y2);
 	}
 
-	SSD1289_setXY(x1,y1,x2,y2,x1,y1);
+	LCD_Window w = { mode, word((x2<<8)+x1), y1, y2, x1, y1 };
+	LCD_Prepare_GRAM(&w);
+}
+
+void UTFTBase::clrXY()
+{
+	// the full window maps to the same GRAM area in either orientation
+	SSD1289_setXY(0,0,disp_x_size,disp_y_size,0,0);
 	SSD1289_dataFollows();
 }
 
-void UTFT::clrXY()
+template <byte O>
+void UTFTBase::setClipRect(int x1, int y1, int x2, int y2)
 {
-	if (orient==PORTRAIT)
-		setXY(0,0,disp_x_size,disp_y_size);
-	else
-		setXY(0,0,disp_y_size,disp_x_size);
+	clrClipRect<O>();
+	if (!clipRect(x1, y1, x2, y2))
+	{
+		// empty, nothing will be drawn until the clip rectangle is reset
+		x1=1;
+		x2=0;
+	}
+	clip_x1=x1;
+	clip_y1=y1;
+	clip_x2=x2;
+	clip_y2=y2;
 }
 
-void UTFT::drawRect(int x1, int y1, int x2, int y2)
+template <byte O>
+void UTFTBase::clrClipRect()
 {
-	
+	clip_x1=0;
+	clip_y1=0;
+	clip_x2=getDisplayXSize<O>()-1;
+	clip_y2=getDisplayYSize<O>()-1;
+}
 
+// Orders the rectangle and trims it to the clip rectangle,
+// returns false if nothing of it is visible.
+bool UTFTBase::clipRect(int &x1, int &y1, int &x2, int &y2)
+{
 	if (x1>x2)
 	{
 		swap(int, x1, x2);
@@ -106,15 +183,32 @@ void UTFT::drawRect(int x1, int y1, int x2, int y2)
 	{
 		swap(int, y1, y2);
 	}
+	if (x1<clip_x1)
+		x1=clip_x1;
+	if (y1<clip_y1)
+		y1=clip_y1;
+	if (x2>clip_x2)
+		x2=clip_x2;
+	if (y2>clip_y2)
+		y2=clip_y2;
+	return x1<=x2 && y1<=y2;
+}
 
-	drawHLine(x1, y1, x2-x1);
-	drawHLine(x1, y2, x2-x1);
-	drawVLine(x1, y1, y2-y1);
-	drawVLine(x2, y1, y2-y1);
+template <byte O>
+void UTFTBase::plotPixel(int x, int y)
+{
+	if (inClip(x, y))
+	{
+		setXY<O>(x, y, x, y);
+		LCD_Write_DATA(fch,fcl);
+	}
 }
 
-void UTFT::drawRoundRect(int x1, int y1, int x2, int y2)
+template <byte O>
+void UTFTBase::drawRect(int x1, int y1, int x2, int y2)
 {
+	
+
 	if (x1>x2)
 	{
 		swap(int, x1, x2);
@@ -123,20 +217,15 @@ void UTFT::drawRoundRect(int x1, int y1, int x2, int y2)
 	{
 		swap(int, y1, y2);
 	}
-	if ((x2-x1)>4 && (y2-y1)>4)
-	{
-		drawPixel(x1+1,y1+1);
-		drawPixel(x2-1,y1+1);
-		drawPixel(x1+1,y2-1);
-		drawPixel(x2-1,y2-1);
-		drawHLine(x1+2, y1, x2-x1-4);
-		drawHLine(x1+2, y2, x2-x1-4);
-		drawVLine(x1, y1+2, y2-y1-4);
-		drawVLine(x2, y1+2, y2-y1-4);
-	}
+
+	drawHLine<O>(x1, y1, x2-x1);
+	drawHLine<O>(x1, y2, x2-x1);
+	drawVLine<O>(x1, y1, y2-y1);
+	drawVLine<O>(x2, y1, y2-y1);
 }
 
-void UTFT::fillRect(int x1, int y1, int x2, int y2)
+template <byte O>
+void UTFTBase::drawRoundRect(int x1, int y1, int x2, int y2)
 {
 	if (x1>x2)
 	{
@@ -146,17 +235,36 @@ void UTFT::fillRect(int x1, int y1, int x2, int y2)
 	{
 		swap(int, y1, y2);
 	}
+	if ((x2-x1)>4 && (y2-y1)>4)
+	{
+		drawPixel<O>(x1+1,y1+1);
+		drawPixel<O>(x2-1,y1+1);
+		drawPixel<O>(x1+1,y2-1);
+		drawPixel<O>(x2-1,y2-1);
+		drawHLine<O>(x1+2, y1, x2-x1-4);
+		drawHLine<O>(x1+2, y2, x2-x1-4);
+		drawVLine<O>(x1, y1+2, y2-y1-4);
+		drawVLine<O>(x2, y1+2, y2-y1-4);
+	}
+}
+
+template <byte O>
+void UTFTBase::fillRect(int x1, int y1, int x2, int y2)
+{
+	if (!clipRect(x1, y1, x2, y2))
+		return;
 
 	cbi(CS_PORT, CS_PIN);
-	setXY(x1, y1, x2, y2);
+	setXY<O>(x1, y1, x2, y2);
 
 	_fast_fill_16(fch,fcl,((long(x2-x1)+1)*(long(y2-y1)+1)));
 
-	cbi(CS_PORT, CS_PIN);
+	sbi(CS_PORT, CS_PIN);
 	
 }
 
-void UTFT::fillRoundRect(int x1, int y1, int x2, int y2)
+template <byte O>
+void UTFTBase::fillRoundRect(int x1, int y1, int x2, int y2)
 {
 	if (x1>x2)
 	{
@@ -174,22 +282,178 @@ void UTFT::fillRoundRect(int x1, int y1, int x2, int y2)
 			switch(i)
 			{
 			case 0:
-				drawHLine(x1+2, y1+i, x2-x1-4);
-				drawHLine(x1+2, y2-i, x2-x1-4);
+				drawHLine<O>(x1+2, y1+i, x2-x1-4);
+				drawHLine<O>(x1+2, y2-i, x2-x1-4);
 				break;
 			case 1:
-				drawHLine(x1+1, y1+i, x2-x1-2);
-				drawHLine(x1+1, y2-i, x2-x1-2);
+				drawHLine<O>(x1+1, y1+i, x2-x1-2);
+				drawHLine<O>(x1+1, y2-i, x2-x1-2);
 				break;
 			default:
-				drawHLine(x1, y1+i, x2-x1);
-				drawHLine(x1, y2-i, x2-x1);
+				drawHLine<O>(x1, y1+i, x2-x1);
+				drawHLine<O>(x1, y2-i, x2-x1);
 			}
 		}
 	}
 }
 
-void UTFT::drawCircle(int x, int y, int radius)
+/*
+  Sets the write mask from an RGB565 mask of the bits to write, widening
+  red and blue to the panel's 6 bits. Expects CS low.
+*/
+static void writeMask(word mask)
+{
+	word keep = ~mask;
+	byte r = keep>>11, g = (keep>>5) & 0x3F, b = keep & 0x1F;
+	
+	r = (r<<1) | (r>>4);
+	b = (b<<1) | (b>>4);
+	SSD1289_writeMask((word(r)<<10) | (word(g)<<2), word(b)<<10);
+}
+
+/*
+  Fills the rectangle with the foreground color, changing only the GRAM
+  bits set in the RGB565 mask. Whatever is already there, text included,
+  keeps its other bits.
+*/
+template <byte O>
+void UTFTBase::fillRectMasked(int x1, int y1, int x2, int y2, word mask)
+{
+	cbi(CS_PORT, CS_PIN);
+	writeMask(mask);
+	sbi(CS_PORT, CS_PIN);
+	
+	fillRect<O>(x1, y1, x2, y2);
+	
+	cbi(CS_PORT, CS_PIN);
+	SSD1289_writeMask(0, 0);
+	sbi(CS_PORT, CS_PIN);
+}
+
+// ORs color into every pixel of the rectangle, e.g. to highlight a key
+template <byte O>
+void UTFTBase::tintRect(int x1, int y1, int x2, int y2, word color)
+{
+	byte ch = fch, cl = fcl;
+	
+	setColor(color);
+	fillRectMasked<O>(x1, y1, x2, y2, color);
+	fch = ch;
+	fcl = cl;
+}
+
+/*
+  Tiles an 8x8 (size 8) or 16x16 (size 16) 1 bit pattern from program
+  memory over the rectangle in the foreground and background colors. Rows
+  are 1 or 2 bytes, most significant bit left. The pattern is anchored to
+  the screen, so neighbouring rectangles continue it seamlessly.
+*/
+template <byte O>
+void UTFTBase::fillRectPattern(int x1, int y1, int x2, int y2, const uint8_t *pattern, byte size)
+{
+	if (!clipRect(x1, y1, x2, y2))
+		return;
+	
+	byte mask = size == 16 ? 15 : 7;
+	
+	cbi(CS_PORT, CS_PIN);
+	setXY<O>(x1, y1, x2, y2);
+	fastpattern(x2-x1+1, y2-y1+1, (uint16_t)pattern, (x1 & mask) | (y1 & mask) << 4, size == 16, (fch<<8)|fcl, (bch<<8)|bcl);
+	sbi(CS_PORT, CS_PIN);
+}
+
+// Channels of an RGB565 color widened to 8 bits
+static void unpack565(word c, byte *rgb)
+{
+	rgb[0] = ((c >> 8) & 0xF8) | (c >> 13);
+	rgb[1] = ((c >> 3) & 0xFC) | ((c >> 9) & 0x03);
+	rgb[2] = ((c << 3) & 0xF8) | ((c >> 2) & 0x07);
+}
+
+/*
+  Linear gradient through evenly spaced color stops, top to bottom or, with
+  horizontal set, left to right. Every line across the gradient has a single
+  color, so for horizontal gradients the entry mode is turned to stream
+  columns and fastgradient packs a color once per line, not per pixel.
+  dither breaks up the RGB565 banding with a 4x4 ordered dither, done in
+  the kernel from the four dithered versions of each line's color.
+*/
+template <byte O>
+void UTFTBase::fillRectGradient(int x1, int y1, int x2, int y2, const word *colors, byte stops, bool horizontal, bool dither)
+{
+	if (stops < 2)
+		return;
+	if (x1>x2)
+	{
+		swap(int, x1, x2);
+	}
+	if (y1>y2)
+	{
+		swap(int, y1, y2);
+	}
+	
+	// the ramp runs over the whole rectangle, clipped or not
+	int a = horizontal ? x1 : y1;
+	long range = horizontal ? x2-x1 : y2-y1;
+	
+	if (!clipRect(x1, y1, x2, y2))
+		return;
+	
+	int ca = horizontal ? x1 : y1;
+	int cb = horizontal ? x2 : y2;
+	word length = horizontal ? y2-y1+1 : x2-x1+1;
+	
+	cbi(CS_PORT, CS_PIN);
+	for (byte i=0; i+1<stops; i++)
+	{
+		// segment from this stop to the next, the last one includes its end
+		int p0 = a + range*i/(stops-1);
+		int p1 = a + range*(i+1)/(stops-1);
+		int l0 = p0 > ca ? p0 : ca;
+		int l1 = i+2 < stops ? p1-1 : p1;
+		if (l1 > cb)
+			l1 = cb;
+		if (l0 > l1)
+			continue;
+		
+		byte c0[3], c1[3];
+		word acc[3], step[3];
+		unpack565(colors[i], c0);
+		unpack565(colors[i+1], c1);
+		for (byte c=0; c<3; c++)
+		{
+			step[c] = p1 > p0 ? ((long)(c1[c] - c0[c]) << 8) / (p1 - p0) : 0;
+			acc[c] = ((word)c0[c] << 8) + 0x80 + step[c]*(l0 - p0);
+		}
+		
+		if (horizontal)
+			setXY<O>(l0, y1, l1, y2, ENTRY_MODE(O) ^ AM);
+		else
+			setXY<O>(x1, l0, x2, l1);
+		if (dither)
+		{
+			// the Bayer pattern is tied to screen x, y in either direction, so
+			// neighbouring fills line up
+			byte phase = horizontal ? (y1 & 3) | ((l0 & 3) << 2) | 0x10 : (x1 & 3) | ((l0 & 3) << 2);
+			fastgradient_dither(length, l1-l0+1, acc[0], acc[1], acc[2], step[0], step[1], step[2], phase);
+		}
+		else
+		{
+			fastgradient(length, l1-l0+1, acc[0], acc[1], acc[2], step[0], step[1], step[2]);
+		}
+	}
+	DATA_PORT_LOW = 0xff;
+	DATA_PORT_HIGH = 0xff;
+	
+	if (horizontal)
+	{
+		SSD1289_reg11(ENTRY_MODE(O));
+	}
+	sbi(CS_PORT, CS_PIN);
+}
+
+template <byte O>
+void UTFTBase::drawCircle(int x, int y, int radius)
 {
 	int f = 1 - radius;
 	int ddF_x = 1;
@@ -198,14 +462,10 @@ void UTFT::drawCircle(int x, int y, int radius)
 	int y1 = radius;
  	
 	cbi(CS_PORT, CS_PIN);
-	setXY(x, y + radius, x, y + radius);
-	LCD_Write_DATA(fch,fcl);
-	setXY(x, y - radius, x, y - radius);
-	LCD_Write_DATA(fch,fcl);
-	setXY(x + radius, y, x + radius, y);
-	LCD_Write_DATA(fch,fcl);
-	setXY(x - radius, y, x - radius, y);
-	LCD_Write_DATA(fch,fcl);
+	plotPixel<O>(x, y + radius);
+	plotPixel<O>(x, y - radius);
+	plotPixel<O>(x + radius, y);
+	plotPixel<O>(x - radius, y);
  
 	while(x1 < y1)
 	{
@@ -218,465 +478,1223 @@ void UTFT::drawCircle(int x, int y, int radius)
 		x1++;
 		ddF_x += 2;
 		f += ddF_x;    
-		setXY(x + x1, y + y1, x + x1, y + y1);
-		LCD_Write_DATA(fch,fcl);
-		setXY(x - x1, y + y1, x - x1, y + y1);
-		LCD_Write_DATA(fch,fcl);
-		setXY(x + x1, y - y1, x + x1, y - y1);
-		LCD_Write_DATA(fch,fcl);
-		setXY(x - x1, y - y1, x - x1, y - y1);
-		LCD_Write_DATA(fch,fcl);
-		setXY(x + y1, y + x1, x + y1, y + x1);
-		LCD_Write_DATA(fch,fcl);
-		setXY(x - y1, y + x1, x - y1, y + x1);
-		LCD_Write_DATA(fch,fcl);
-		setXY(x + y1, y - x1, x + y1, y - x1);
-		LCD_Write_DATA(fch,fcl);
-		setXY(x - y1, y - x1, x - y1, y - x1);
-		LCD_Write_DATA(fch,fcl);
+		plotPixel<O>(x + x1, y + y1);
+		plotPixel<O>(x - x1, y + y1);
+		plotPixel<O>(x + x1, y - y1);
+		plotPixel<O>(x - x1, y - y1);
+		plotPixel<O>(x + y1, y + x1);
+		plotPixel<O>(x - y1, y + x1);
+		plotPixel<O>(x + y1, y - x1);
+		plotPixel<O>(x - y1, y - x1);
 	}
 	sbi(CS_PORT, CS_PIN);
 	clrXY();
 }
 
-void UTFT::fillCircle(int x, int y, int radius)
+template <byte O>
+void UTFTBase::fillCircle(int x, int y, int radius)
 {
 	for(int y1=-radius; y1<=0; y1++) 
 		for(int x1=-radius; x1<=0; x1++)
 			if(x1*x1+y1*y1 <= radius*radius) 
 			{
-				drawHLine(x+x1, y+y1, 2*(-x1));
-				drawHLine(x+x1, y-y1, 2*(-x1));
+				drawHLine<O>(x+x1, y+y1, 2*(-x1));
+				drawHLine<O>(x+x1, y-y1, 2*(-x1));
 				break;
 			}
 }
 
-void UTFT::clrScr()
-{
-		
-	cbi(CS_PORT, CS_PIN);
-
-
-	SSD1289_setXY(0,0, 239, 319, 0, 0);
-	SSD1289_reg11(0x6040 |ID1|ID0|AM);
-	SSD1289_dataFollows();
-
-	DATA_PORT_LOW = 0x00;
-	DATA_PORT_HIGH = 0;
-	fastfill((uint32_t)76800);
-	DATA_PORT_LOW = 0xff;
-	DATA_PORT_HIGH = 0xff;
-
-	cbi(CS_PORT, CS_PIN);
-}
-
-void UTFT::fillScr(byte r, byte g, byte b)
+// Integer division rounding down/up, b > 0.
+static long floorDiv(long a, long b)
 {
-	word color = ((r&248)<<8 | (g&252)<<3 | (b&248)>>3);
-	fillScr(color);
+	return a >= 0 ? a / b : -((b - 1 - a) / b);
 }
 
-
-int UTFT::setPixels( word color, uint16_t x, uint16_t y, uint32_t pixels )
+static long ceilDiv(long a, long b)
 {
-
-	char ch, cl;
-	
-	ch=color>>8;
-	cl=color & 0xFF;
-
-	cbi(CS_PORT, CS_PIN);
-	clrXY();
-	_fast_fill_16(ch,cl,pixels);
-	sbi(CS_PORT, CS_PIN);
-	return 0;
+	return -floorDiv(-a, b);
 }
 
-void UTFT::fillScr(word color)
+// Integer square root, rounded down
+static uint32_t isqrt(uint32_t v)
 {
-
-	unsigned char ch, cl;
-	
-	ch=color>>8;
-	cl=color & 0xFF;
-	
-	
-	cbi(CS_PORT, CS_PIN);
-	
-	SSD1289_setXY(0,0, 239, 319, 0, 0);
-	SSD1289_reg11(0x6040 |ID1|ID0|AM);
-	SSD1289_dataFollows();
-	
-	DATA_PORT_LOW = cl;
-	DATA_PORT_HIGH = ch;
-	fastfill((uint32_t)320*240);
-	DATA_PORT_LOW = 0xff;
-	DATA_PORT_HIGH = 0xff;	
+	uint32_t r = 0, bit = 1UL << 30;
 	
-	sbi(CS_PORT, CS_PIN);
-}
-
-void UTFT::setColor(byte r, byte g, byte b)
-{
-	fch=((r&248)|g>>5);
-	fcl=((g&28)<<3|b>>3);
-}
-
-void UTFT::setColor(word color)
-{
-	fch=color>>8;
-	fcl=color & 0xFF;
-}
-
-word UTFT::getColor()
-{
-	return (fch<<8) | fcl;
-}
-
-void UTFT::setBackColor(byte r, byte g, byte b)
-{
-	bch=((r&248)|g>>5);
-	bcl=((g&28)<<3|b>>3);
+	while (bit > v)
+		bit >>= 2;
+	while (bit)
+	{
+		if (v >= r + bit)
+		{
+			v -= r + bit;
+			r = (r >> 1) + bit;
+		}
+		else
+			r >>= 1;
+		bit >>= 2;
+	}
+	return r;
 }
 
-void UTFT::setBackColor(word color)
-{
-	bch=color>>8;
-	bcl=color & 0xFF;
-}
+// How far off the clip rectangle thick line ends are trimmed, the products
+// in drawLine stay below 2^30 up to there
+#define LINE_TRIM 8192
 
-word UTFT::getBackColor()
+// Sides of the rectangle the point lies beyond, one bit each
+static byte outcode(long x, long y, int x1, int y1, int x2, int y2)
 {
-	return (bch<<8) | bcl;
+	return (x < x1) | (x > x2) << 1 | (y < y1) << 2 | (y > y2) << 3;
 }
 
-void UTFT::setPixel(word color)
+/*
+  Moves the ends of the segment into the rectangle, each to where the line
+  crosses its edge, found by bisection so nothing can overflow and the ends
+  stay within a pixel of the line. False if the segment misses it.
+*/
+static bool trimSegment(int &xa, int &ya, int &xb, int &yb, int x1, int y1, int x2, int y2)
 {
-	LCD_Write_DATA((color>>8),(color&0xFF));	// rrrrrggggggbbbbb
+	for (;;)
+	{
+		byte ca = outcode(xa, ya, x1, y1, x2, y2);
+		byte cb = outcode(xb, yb, x1, y1, x2, y2);
+		
+		if (ca & cb)
+			return false;
+		if (!ca && !cb)
+			return true;
+		if (!ca)
+		{
+			swap(int, xa, xb);
+			swap(int, ya, yb);
+			ca = cb;
+		}
+		
+		// beyond a's sides holds at a and not at b, find where it stops
+		long lx = xa, ly = ya, hx = xb, hy = yb;
+		while (labs(hx-lx) > 1 || labs(hy-ly) > 1)
+		{
+			long mx = (lx+hx) >> 1, my = (ly+hy) >> 1;
+			if (outcode(mx, my, x1, y1, x2, y2) & ca)
+			{
+				lx = mx;
+				ly = my;
+			}
+			else
+			{
+				hx = mx;
+				hy = my;
+			}
+		}
+		xa = hx;
+		ya = hy;
+	}
 }
 
-void UTFT::drawPixel(int x, int y)
-{
-	cbi(CS_PORT, CS_PIN);
-	setXY(x, y, x, y);
-	setPixel((fch<<8)|fcl);	
-	sbi(CS_PORT, CS_PIN);
-}
-		
-void UTFT::drawLine(int xa, int ya, int xb, int yb)
+/*
+  Line of the given width with square (butt) ends, drawn as one horizontal
+  span per row so every pixel is written once. Axis aligned lines become a
+  single fillRect. A pixel is on the stroke when its distance from the
+  center line is in (-width/2, width/2] and it lies between the endpoints.
+*/
+template <byte O>
+void UTFTBase::drawLine(int xa, int ya, int xb, int yb, int width)
 {
+	if (width <= 1)
+	{
+		drawLine<O>(xa, ya, xb, yb);
+		return;
+	}
+	// ends far off screen are trimmed so the math below stays in 32 bits,
+	// far enough out that the pixel they may move by doesn't show
+	if (!trimSegment(xa, ya, xb, yb, clip_x1-LINE_TRIM, clip_y1-LINE_TRIM, clip_x2+LINE_TRIM, clip_y2+LINE_TRIM))
+		return;
 	if (ya==yb)
 	{
-		drawHLine(xa, ya, xb-xa);
+		fillRect<O>(xa, ya-(width-1)/2, xb, ya+width/2);
 		return;
-	}			
+	}
 	if (xa==xb)
 	{
-		drawVLine(xa, ya, yb-ya);
+		fillRect<O>(xa-width/2, ya, xa+(width-1)/2, yb);
 		return;
 	}
 	
-	if (orient==LANDSCAPE)
+	if (ya > yb)
 	{
-		swap(uint16_t, xa, ya);
-		swap(uint16_t, xb, yb);
-		ya=disp_y_size-ya;
-		yb=disp_y_size-yb;
-	}		
-
-
-	uint16_t dx = abs(xb - xa);
-	uint16_t dy = abs(yb - ya);
+		swap(int, xa, xb);
+		swap(int, ya, yb);
+	}
 	
-	cbi(CS_PORT, CS_PIN);	
-	SSD1289_setXY(0,0, 239, 319, xa, ya);
+	long dx = xb - xa;
+	long dy = yb - ya;
+	long l2 = dx*dx + dy*dy;
 	
-	if ( dx < dy ) 
+	// the length with 6 fraction bits, as many as l2 leaves room for
+	uint32_t s = l2;
+	byte f = 6;
+	while (f && s < (1UL << 30))
 	{
-		if ( ya < yb )
-		{			
-			if ( xa < xb ) 
-			{
-				SSD1289_reg11(0x6040 |ID1|ID0|AM);
-				SSD1289_dataFollows();
-
-				fastlineAPP(fcl | fch << 8, xa, xb, ya, yb, dx, dy);
-			}			
-			else
-			{
-				SSD1289_reg11(0x6040 |ID1|ID0|AM);
-				SSD1289_dataFollows();
-
-				fastlineANP(fcl | fch << 8, xa, xb, ya, yb, dx, dy);				
-			}
-		}
-		else
-		{
-			if ( xa < xb )
-			{
-				SSD1289_reg11(0x6040|ID0|AM);
-				SSD1289_dataFollows();
-											
-				fastlineAPN(fcl | fch << 8, xa, xb, ya, yb, dx, dy);
-			}
-			else
-			{
-				SSD1289_reg11(0x6040|ID0|AM);
-				SSD1289_dataFollows();
-								
-				fastlineANN(fcl | fch << 8, xa, xb, ya, yb, dx, dy);							
-			}			
-		}			
+		s <<= 2;
+		f--;
 	}
-	else
+	long len = (long)isqrt(s) << f;
+	
+	// half width, scaled by 2*length
+	long k = (width*len + 32) >> 6;
+	
+	int y1 = ya - width, y2 = yb + width;
+	if (y1 < clip_y1)
+		y1 = clip_y1;
+	if (y2 > clip_y2)
+		y2 = clip_y2;
+	
+	cbi(CS_PORT, CS_PIN);
+	for (int y=y1; y<=y2; y++)
 	{
+		long t = y - ya;
+		long u1, u2;
 		
-		if ( ya < yb )
-		{
-			if ( xa < xb )
-			{
-				SSD1289_reg11(0x6040 |ID1|ID0);
-				SSD1289_dataFollows();
+		// across the line: -k <= 2*(u*dy - t*dx) < k
+		u1 = ceilDiv(2*t*dx - k, 2*dy);
+		u2 = ceilDiv(2*t*dx + k, 2*dy) - 1;
 		
-				fastlineBPP(fcl | fch << 8, xa, xb, ya, yb, dx, dy);
-			}
-			else
-			{
-				SSD1289_reg11(0x6040 |ID1);
-				SSD1289_dataFollows();
-				
-				fastlineBNP(fcl | fch << 8, xa, xb, ya, yb, dx, dy);							
-			}				
-		}	
-		else
-		{
-			if ( xa < xb )
-			{
-				SSD1289_reg11(0x6040 |ID0);
-				SSD1289_dataFollows();
-				
-				fastlineBPN(fcl | fch << 8, xa, xb, ya, yb, dx, dy);
-			}
-			else
-			{
-				
-				SSD1289_reg11(0x6040 |ID1);
-				SSD1289_dataFollows();
-				
-				fastlineBNN(fcl | fch << 8, xa, xb, ya, yb, dx, dy);
-			}			
-		}				
+		// along the line: 0 <= u*dx + t*dy <= l2
+		long e = t*dy;
+		long v1 = dx > 0 ? ceilDiv(-e, dx) : ceilDiv(e - l2, -dx);
+		long v2 = dx > 0 ? floorDiv(l2 - e, dx) : floorDiv(e, -dx);
+		if (v1 > u1)
+			u1 = v1;
+		if (v2 < u2)
+			u2 = v2;
 		
+		u1 += xa;
+		u2 += xa;
+		if (u1 < clip_x1)
+			u1 = clip_x1;
+		if (u2 > clip_x2)
+			u2 = clip_x2;
+		fillSpan<O>(u1, u2, y);
 	}
-	
 	sbi(CS_PORT, CS_PIN);
-	
-}	
-
+}
 
-void UTFT::drawHLine(int x, int y, int l)
+/*
+  Rectangle outline width pixels thick, growing inwards from the given
+  corners. Four bands, no pixel is written twice.
+*/
+template <byte O>
+void UTFTBase::drawRect(int x1, int y1, int x2, int y2, int width)
 {
-	if (l<0)
+	if (x1>x2)
 	{
-		l = -l;
-		x -= l;
+		swap(int, x1, x2);
+	}
+	if (y1>y2)
+	{
+		swap(int, y1, y2);
+	}
+	if (width <= 1)
+	{
+		drawRect<O>(x1, y1, x2, y2);
+		return;
+	}
+	if (2*width > x2-x1 || 2*width > y2-y1)
+	{
+		fillRect<O>(x1, y1, x2, y2);
+		return;
 	}
 	
-	cbi(CS_PORT, CS_PIN);
-	
-	setXY(x, y, x+l, y);
-	_fast_fill_16(fch,fcl,l);
-	sbi(CS_PORT, CS_PIN);
+	fillRect<O>(x1, y1, x2, y1+width-1);
+	fillRect<O>(x1, y2-width+1, x2, y2);
+	fillRect<O>(x1, y1+width, x1+width-1, y2-width);
+	fillRect<O>(x2-width+1, y1+width, x2, y2-width);
 }
 
-void UTFT::drawVLine(int x, int y, int l)
+/*
+  Circle outline width pixels thick, centered on radius: the disc of
+  radius+width/2 minus the disc width smaller, a full fillArc ring.
+*/
+template <byte O>
+void UTFTBase::drawCircle(int x, int y, int radius, int width)
 {
-	if (l<0)
+	if (width <= 1)
 	{
-		l = -l;
-		y -= l;
+		drawCircle<O>(x, y, radius);
+		return;
 	}
-	cbi(CS_PORT, CS_PIN);
-	setXY(x, y, x, y+l);
-	_fast_fill_16(fch,fcl,l);
-	sbi(CS_PORT, CS_PIN);	
-
+	
+	int ro = radius + width/2;
+	fillArc<O>(x, y, ro - width, ro, 0, 360);
 }
 
-
-void UTFT::printChar(byte c, int x, int y)
+/*
+  Ellipse with radii rx and ry, walked row by row from the middle out: xo is
+  the last pixel inside (x*ry)^2 + (t*rx)^2 <= (rx*ry)^2 on row t, kept up
+  to date with additions only. The outline of a row runs from just outside
+  the next row's extent to xo, so flat parts come out as one span.
+*/
+template <byte O>
+void UTFTBase::ellipse(int x, int y, int rx, int ry, bool fill)
 {
-
-	word temp;
-
-	cbi(CS_PORT, CS_PIN);
+	if (rx < 0 || ry < 0)
+		return;
 	
-	if (orient==PORTRAIT)
+	long rx2 = (long)rx*rx;
+	long ry2 = (long)ry*ry;
+	long d = 0;				// (xo*ry)^2 + (t*rx)^2 - (rx*ry)^2
+	int xo = rx;
+	
+	cbi(CS_PORT, CS_PIN);
+	for (int t=0; t<=ry; t++)
 	{
+		int cur = xo;
 		
-		temp=((c-cfont.offset)*((cfont.x_size/8)*cfont.y_size))+4;
-
-		uint16_t x1 = x;
-		uint16_t x2 = x + cfont.x_size -1;
-		uint16_t y1 = y;
-		uint16_t y2 = y+cfont.y_size-1;
-		
-
-		SSD1289_setXY(x1,y1, x2, y2, x1, y1);
-		SSD1289_reg11(0x6040 |ID0|ID1);
-		SSD1289_dataFollows();		
+		// extent of the next row
+		d += (2L*t + 1)*rx2;
+		while (d > 0 && xo >= 0)
+		{
+			d -= (2L*xo - 1)*ry2;
+			xo--;
+		}
+		int lo = 0;
+		if (!fill && t < ry)
+			lo = xo+1 < cur ? xo+1 : cur;
 		
-		fastbitmap_1bit(cfont.y_size * cfont.x_size/8, (uint16_t)cfont.font + temp,(fch<<8)|fcl,(bch<<8)|bcl);
+		int rows[2] = { y+t, y-t };
+		for (byte i=0; i<(t ? 2 : 1); i++)
+		{
+			if (lo == 0)
+			{
+				fillSpan<O>(x-cur, x+cur, rows[i]);
+			}
+			else
+			{
+				fillSpan<O>(x-cur, x-lo, rows[i]);
+				fillSpan<O>(x+lo, x+cur, rows[i]);
+			}
+		}
 	}
-	else
-	{
-		temp=((c-cfont.offset)*((cfont.x_size/8)*cfont.y_size))+4;
+	sbi(CS_PORT, CS_PIN);
+}
 
-		uint16_t x1 = x;
-		uint16_t x2 = x + cfont.x_size -1;			
-		uint16_t y1 = y;
-		uint16_t y2 = y+cfont.y_size-1;
-			
-			
-		swap(uint16_t, x1, y1);
-		swap(uint16_t, x2, y2)
-		y1=disp_y_size-y1;
-		y2=disp_y_size-y2;
-		swap(uint16_t, y1, y2)			
-			
-		SSD1289_setXY(x1,y1, x2, y2, x1, y2);
-		SSD1289_reg11(0x6040 |ID0|AM);
-		SSD1289_dataFollows();			
-					
-		fastbitmap_1bit(cfont.y_size * cfont.x_size/8, (uint16_t)cfont.font + temp,(fch<<8)|fcl,(bch<<8)|bcl);
+// x range of a row, empty when hi < lo
+struct Span
+{
+	int lo, hi;
+};
 
-		
-	}
-	sbi(CS_PORT, CS_PIN);
+static int clampSpan(long v)
+{
+	return v < -32767 ? -32767 : v > 32767 ? 32767 : v;
+}
+
+// Row dy of the half plane vy*x <= vx*dy
+static Span halfPlane(long vx, long vy, int dy)
+{
+	Span s = { -32767, 32767 };
+	long c = vx*dy;
 	
+	if (vy > 0)
+		s.hi = clampSpan(floorDiv(c, vy));
+	else if (vy < 0)
+		s.lo = clampSpan(ceilDiv(-c, -vy));
+	else if (c < 0)
+		s.hi = s.lo - 1;
+	return s;
 }
 
-void UTFT::rotateChar(byte c, int x, int y, int pos, int deg)
+// sin of 0..90 degrees in Q14, isin folds the other quadrants onto it
+static const uint16_t sine_q14[91] PROGMEM =
 {
-	byte i,j,ch;
-	word temp; 
-	int newx,newy;
-	double radian;
-	radian=deg*0.0175;  
+	0, 286, 572, 857, 1143, 1428, 1713, 1997, 2280, 2563,
+	2845, 3126, 3406, 3686, 3964, 4240, 4516, 4790, 5063, 5334,
+	5604, 5872, 6138, 6402, 6664, 6924, 7182, 7438, 7692, 7943,
+	8192, 8438, 8682, 8923, 9162, 9397, 9630, 9860, 10087, 10311,
+	10531, 10749, 10963, 11174, 11381, 11585, 11786, 11982, 12176, 12365,
+	12551, 12733, 12911, 13085, 13255, 13421, 13583, 13741, 13894, 14044,
+	14189, 14330, 14466, 14598, 14726, 14849, 14968, 15082, 15191, 15296,
+	15396, 15491, 15582, 15668, 15749, 15826, 15897, 15964, 16026, 16083,
+	16135, 16182, 16225, 16262, 16294, 16322, 16344, 16362, 16374, 16382,
+	16384
+};
+
+// sin(deg) * 16384 for any whole degree
+static long isin(int deg)
+{
+	deg %= 360;
+	if (deg < 0)
+		deg += 360;
+	
+	int q = deg < 180 ? deg : deg - 180;
+	long s = pgm_read_word(&sine_q14[q <= 90 ? q : 180 - q]);
+	return deg < 180 ? s : -s;
+}
 
+/*
+  Annular sector: the disc of radius r2 minus the disc of radius r1 (the
+  fillCircle test, r1 < 0 for no hole), from angle start clockwise to end in
+  degrees, 0 pointing right. Per row the ring is at most two spans and the
+  sector one or two more ranges bounded by the start and end rays, so every
+  row costs a few divisions plus its spans, and no pixel is written twice.
+*/
+template <byte O>
+void UTFTBase::fillArc(int x, int y, int r1, int r2, int start, int end)
+{
+	if (r2 < 0 || r1 >= r2)
+		return;
+	
+	while (end <= start)
+		end += 360;
+	bool full = end - start >= 360;
+	bool wide = end - start > 180;
+	
+	// the sector is left of the start ray and right of the end ray,
+	// both of them for narrow sectors, either for wide ones
+	long v0x = isin(start+90), v0y = isin(start);
+	long v1x = -isin(end+90), v1y = -isin(end);
+	
+	long ro2 = (long)r2*r2;
+	long ri2 = (long)r1*r1;
+	int xo = r2, xi = r1;
+	
 	cbi(CS_PORT, CS_PIN);
-
-	temp=((c-cfont.offset)*((cfont.x_size/8)*cfont.y_size))+4;
-	for(j=0;j<cfont.y_size;j++) 
+	for (int t=0; t<=r2; t++)
 	{
-		for (int zz=0; zz<(cfont.x_size/8); zz++)
+		long t2 = (long)t*t;
+		
+		while ((long)xo*xo + t2 > ro2)
+			xo--;
+		if (t <= r1)
 		{
-			ch=pgm_read_byte(&cfont.font[temp+zz]); 
-			for(i=0;i<8;i++)
-			{   
-				newx=x+(((i+(zz*8)+(pos*cfont.x_size))*cos(radian))-((j)*sin(radian)));
-				newy=y+(((j)*cos(radian))+((i+(zz*8)+(pos*cfont.x_size))*sin(radian)));
-
-				setXY(newx,newy,newx+1,newy+1);
+			while ((long)xi*xi + t2 > ri2)
+				xi--;
+		}
+		
+		int rows[2] = { t, -t };
+		for (byte k=0; k<(t ? 2 : 1); k++)
+		{
+			int dy = rows[k];
+			Span ring[2] = { { -xo, xo }, { 1, 0 } };
+			Span sec[2] = { { -32767, 32767 }, { 1, 0 } };
+			
+			if (t <= r1)
+			{
+				ring[0].hi = -xi-1;
+				ring[1].lo = xi+1;
+				ring[1].hi = xo;
+			}
+			
+			if (!full)
+			{
+				Span a = halfPlane(v0x, v0y, dy);
+				Span b = halfPlane(v1x, v1y, dy);
 				
-				if((ch&(1<<(7-i)))!=0)   
+				if (!wide)
 				{
-					setPixel((fch<<8)|fcl);
-				} 
-				else  
+					sec[0].lo = a.lo > b.lo ? a.lo : b.lo;
+					sec[0].hi = a.hi < b.hi ? a.hi : b.hi;
+				}
+				else if (a.hi < b.lo-1 || b.hi < a.lo-1)
 				{
-					setPixel((bch<<8)|bcl);
-				}   
+					sec[0] = a;
+					sec[1] = b;
+				}
+				else
+				{
+					sec[0].lo = a.lo < b.lo ? a.lo : b.lo;
+					sec[0].hi = a.hi > b.hi ? a.hi : b.hi;
+				}
+			}
+			
+			for (byte i=0; i<2; i++)
+			{
+				for (byte j=0; j<2; j++)
+				{
+					int lo = ring[i].lo > sec[j].lo ? ring[i].lo : sec[j].lo;
+					int hi = ring[i].hi < sec[j].hi ? ring[i].hi : sec[j].hi;
+					fillSpan<O>(x+lo, x+hi, y+dy);
+				}
 			}
 		}
-		temp+=(cfont.x_size/8);
 	}
 	sbi(CS_PORT, CS_PIN);
 }
 
-void UTFT::print(const char *st, int x, int y, int deg)
+/*
+  Polygon edge for the scanline fillers. It covers rows y1 <= y < y2, x is
+  stepped down the rows as x + e/dy with 0 <= e < dy.
+*/
+struct PolyEdge
 {
-	int stl, i;
-
-	stl = strlen(st);
-
-	if (orient==PORTRAIT)
+	int x, e;
+	int q, rem, dy;
+	int y1, y2;
+	int8_t dir;		// winding, +1 going down, -1 going up
+};
+
+// Sets the edge up at row y (or its top row if that is further down),
+// false for horizontal edges, they never cross a row.
+static bool edgeInit(PolyEdge &edge, int xa, int ya, int xb, int yb, int y)
+{
+	edge.dir = 1;
+	if (ya == yb)
+		return false;
+	if (ya > yb)
 	{
-	if (x==RIGHT)
-		x=(disp_x_size+1)-(stl*cfont.x_size);
-	if (x==CENTER)
-		x=((disp_x_size+1)-(stl*cfont.x_size))/2;
+		swap(int, xa, xb);
+		swap(int, ya, yb);
+		edge.dir = -1;
 	}
-	else
+	
+	int dx = xb - xa;
+	edge.dy = yb - ya;
+	edge.q = floorDiv(dx, edge.dy);
+	edge.rem = dx - edge.q*edge.dy;
+	edge.y1 = ya;
+	edge.y2 = yb;
+	
+	long n = y > ya ? (long)(y - ya)*dx : 0;
+	long f = floorDiv(n, edge.dy);
+	edge.x = xa + f;
+	edge.e = n - f*edge.dy;
+	return true;
+}
+
+static void edgeStep(PolyEdge &edge)
+{
+	edge.x += edge.q;
+	edge.e += edge.rem;
+	if (edge.e >= edge.dy)
 	{
-	if (x==RIGHT)
-		x=(disp_y_size+1)-(stl*cfont.x_size);
-	if (x==CENTER)
-		x=((disp_y_size+1)-(stl*cfont.x_size))/2;
+		edge.e -= edge.dy;
+		edge.x++;
 	}
-
-	for (i=0; i < stl; i++)
-		if (deg==0)
-			printChar(*st++, x + (i*(cfont.x_size)), y);
-		else
-			rotateChar(*st++, x, y, i, deg);
 }
 
-void UTFT::printWithMargin(const char *st, int x, int y, int limit)
+// First pixel at or right of the edge on the current row
+static int edgeX(const PolyEdge &edge)
 {
-	int stl, i;
-
-	stl = strlen(st);
+	return edge.x + (edge.e > 0);
+}
 
-	if (orient==PORTRAIT)
+/*
+  Filled triangle, one span per row between the long edge (top to bottom
+  vertex) and the upper or lower short edge. Same fill rule as fillPolygon.
+*/
+template <byte O>
+void UTFTBase::fillTriangle(int x0, int y0, int x1, int y1, int x2, int y2)
+{
+	if (y0 > y1)
 	{
-		if (x==RIGHT)
-		x=(disp_x_size+1)-(stl*cfont.x_size);
-		if (x==CENTER)
-		x=((disp_x_size+1)-(stl*cfont.x_size))/2;
+		swap(int, x0, x1);
+		swap(int, y0, y1);
 	}
-	else
+	if (y1 > y2)
 	{
-		if (x==RIGHT)
-		x=(disp_y_size+1)-(stl*cfont.x_size);
-		if (x==CENTER)
-		x=((disp_y_size+1)-(stl*cfont.x_size))/2;
+		swap(int, x1, x2);
+		swap(int, y1, y2);
 	}
-
-	uint8_t indx = y;
-	for (i=0; i < stl; i++) {
-		if(i != 0 && (i % limit) == 0) indx += 12;
+	if (y0 > y1)
+	{
+		swap(int, x0, x1);
+		swap(int, y0, y1);
+	}
+	
+	int ya = y0 > clip_y1 ? y0 : clip_y1;
+	int yb = y2-1 < clip_y2 ? y2-1 : clip_y2;
+	PolyEdge edge, upper, lower;
+	
+	if (!edgeInit(edge, x0, y0, x2, y2, ya))
+		return;
+	edgeInit(upper, x0, y0, x1, y1, ya);
+	edgeInit(lower, x1, y1, x2, y2, ya);
+	
+	cbi(CS_PORT, CS_PIN);
+	for (int y=ya; y<=yb; y++)
+	{
+		PolyEdge &side = y < y1 ? upper : lower;
+		int xl = edgeX(edge);
+		int xr = edgeX(side);
 		
-		printChar(*st++, (x + ((i % limit)*(cfont.x_size))), indx);
+		if (xl > xr)
+		{
+			swap(int, xl, xr);
+		}
+		fillSpan<O>(xl, xr-1, y);
+		edgeStep(edge);
+		edgeStep(side);
 	}
+	sbi(CS_PORT, CS_PIN);
 }
 
-
-void UTFT::printNumI(uint8_t num, int x, int y, int length, char filler)
+/*
+  Filled polygon through the points of xy (x0, y0, x1, y1, ...), in RAM or
+  with pgm set in program memory, at most POLYGON_MAX_POINTS of them. Rows
+  are scanned against an edge table stepped incrementally; the inside is
+  picked by the nonzero winding rule or, by default, even-odd. A pixel is
+  filled when its top left corner is inside, so polygons sharing an edge
+  tile without overlap. Every row is written as whole spans.
+*/
+template <byte O>
+void UTFTBase::fillPolygon(const int *xy, int points, bool nonzero, bool pgm)
 {
-	char buf[4];
-	char st[4];
-	bool neg=false;
-	int c=0, f=0;
-  
-	if (num==0)
+	if (points < 3 || points > POLYGON_MAX_POINTS)
+		return;
+	
+	int vx[POLYGON_MAX_POINTS], vy[POLYGON_MAX_POINTS];
+	int ya = 32767, yb = -32768;
+	
+	for (byte i=0; i<points; i++)
 	{
-		if (length!=0)
-		{
-			for (c=0; c<(length-1); c++)
-				st[c]=filler;
-			st[c]=48;
-			st[c+1]=0;
-		}
-		else
-		{
-			st[0]=48;
-			st[1]=0;
-		}
+		vx[i] = pgm ? (int)pgm_read_word(&xy[2*i]) : xy[2*i];
+		vy[i] = pgm ? (int)pgm_read_word(&xy[2*i+1]) : xy[2*i+1];
+		if (vy[i] < ya)
+			ya = vy[i];
+		if (vy[i] > yb)
+			yb = vy[i];
+	}
+	
+	if (points == 3)
+	{
+		fillTriangle<O>(vx[0], vy[0], vx[1], vy[1], vx[2], vy[2]);
+		return;
 	}
+	
+	if (ya < clip_y1)
+		ya = clip_y1;
+	if (yb-1 < clip_y2)
+		yb = yb-1;
 	else
+		yb = clip_y2;
+	
+	PolyEdge edges[POLYGON_MAX_POINTS];
+	byte n = 0;
+	
+	for (byte i=0; i<points; i++)
 	{
-		while (num>0)
+		byte j = i+1 < points ? i+1 : 0;
+		if (edgeInit(edges[n], vx[i], vy[i], vx[j], vy[j], ya))
+			n++;
+	}
+	
+	cbi(CS_PORT, CS_PIN);
+	for (int y=ya; y<=yb; y++)
+	{
+		int xs[POLYGON_MAX_POINTS];
+		int8_t ds[POLYGON_MAX_POINTS];
+		byte k = 0;
+		
+		// crossings of this row, insertion sorted by x
+		for (byte i=0; i<n; i++)
+		{
+			PolyEdge &edge = edges[i];
+			if (y < edge.y1 || y >= edge.y2)
+				continue;
+			
+			int x = edgeX(edge);
+			byte j = k++;
+			while (j && xs[j-1] > x)
+			{
+				xs[j] = xs[j-1];
+				ds[j] = ds[j-1];
+				j--;
+			}
+			xs[j] = x;
+			ds[j] = edge.dir;
+			edgeStep(edge);
+		}
+		
+		int8_t wind = 0;
+		int start = 0;
+		for (byte i=0; i<k; i++)
+		{
+			bool in = nonzero ? wind != 0 : (wind & 1);
+			wind += nonzero ? ds[i] : 1;
+			bool now = nonzero ? wind != 0 : (wind & 1);
+			
+			if (now && !in)
+				start = xs[i];
+			else if (in && !now)
+				fillSpan<O>(start, xs[i]-1, y);
+		}
+	}
+	sbi(CS_PORT, CS_PIN);
+}
+
+template <byte O>
+void UTFTBase::clrScr()
+{
+	fillScr<O>(VGA_BLACK);
+}
+
+template <byte O>
+void UTFTBase::fillScr(byte r, byte g, byte b)
+{
+	word color = ((r&248)<<8 | (g&252)<<3 | (b&248)>>3);
+	fillScr<O>(color);
+}
+
+
+int UTFTBase::setPixels( word color, uint16_t x, uint16_t y, uint32_t pixels )
+{
+
+	char ch, cl;
+	
+	ch=color>>8;
+	cl=color & 0xFF;
+
+	cbi(CS_PORT, CS_PIN);
+	clrXY();
+	_fast_fill_16(ch,cl,pixels);
+	sbi(CS_PORT, CS_PIN);
+	return 0;
+}
+
+template <byte O>
+void UTFTBase::fillScr(word color)
+{
+
+	unsigned char ch, cl;
+	
+	ch=color>>8;
+	cl=color & 0xFF;
+	
+	
+	cbi(CS_PORT, CS_PIN);
+	
+	// fills the whole screen unless a clip rectangle is set
+	setXY<O>(clip_x1, clip_y1, clip_x2, clip_y2);
+	
+	_fast_fill_16(ch,cl,((long(clip_x2-clip_x1)+1)*(long(clip_y2-clip_y1)+1)));
+	
+	sbi(CS_PORT, CS_PIN);
+}
+
+void UTFTBase::setColor(byte r, byte g, byte b)
+{
+	fch=((r&248)|g>>5);
+	fcl=((g&28)<<3|b>>3);
+}
+
+void UTFTBase::setColor(word color)
+{
+	fch=color>>8;
+	fcl=color & 0xFF;
+}
+
+word UTFTBase::getColor()
+{
+	return (fch<<8) | fcl;
+}
+
+void UTFTBase::setBackColor(byte r, byte g, byte b)
+{
+	bch=((r&248)|g>>5);
+	bcl=((g&28)<<3|b>>3);
+}
+
+void UTFTBase::setBackColor(word color)
+{
+	bch=color>>8;
+	bcl=color & 0xFF;
+}
+
+word UTFTBase::getBackColor()
+{
+	return (bch<<8) | bcl;
+}
+
+void UTFTBase::setPixel(word color)
+{
+	LCD_Write_DATA((color>>8),(color&0xFF));	// rrrrrggggggbbbbb
+}
+
+template <byte O>
+void UTFTBase::drawPixel(int x, int y)
+{
+	if (!inClip(x, y))
+		return;
+
+	cbi(CS_PORT, CS_PIN);
+	setXY<O>(x, y, x, y);
+	setPixel((fch<<8)|fcl);	
+	sbi(CS_PORT, CS_PIN);
+}
+		
+/*
+  Trims a Bresenham line to the clip rectangle so the kernels only walk the
+  visible pixels. The line runs from (ma, na) for dmaj steps along the major
+  axis; step i is at minor offset (dmaj/2 + i*dmin) / dmaj, exactly as the
+  fastline kernels step it. On return ma/na/mb are the first and last visible
+  major positions and num is the kernel's error term at the first one.
+  skip drops step 0. dmin may be 0 for straight lines.
+*/
+static bool clipLine(int &ma, int &na, int &mb, uint16_t dmaj, uint16_t dmin, bool minc, bool ninc,
+					 int mlo, int mhi, int nlo, int nhi, bool skip, uint16_t &num)
+{
+	uint16_t h = dmaj >> 1;
+	long first, last, klo, khi;
+	
+	// visible steps along the major axis
+	if (minc)
+	{
+		first = mlo - ma;
+		last = mhi - ma;
+	}
+	else
+	{
+		first = ma - mhi;
+		last = ma - mlo;
+	}
+	if (first < skip)
+		first = skip;
+	if (last > dmaj)
+		last = dmaj;
+	
+	// visible minor offsets, turned into steps
+	if (ninc)
+	{
+		klo = nlo - na;
+		khi = nhi - na;
+	}
+	else
+	{
+		klo = na - nhi;
+		khi = na - nlo;
+	}
+	if (klo > 0)
+	{
+		if (!dmin)
+			return false;
+		long i = ((uint32_t)klo*dmaj - h + dmin - 1) / dmin;
+		if (i > first)
+			first = i;
+	}
+	if (khi < (long)dmin)
+	{
+		if (khi < 0)
+			return false;
+		long i = ((uint32_t)(khi+1)*dmaj - h - 1) / dmin;
+		if (i < last)
+			last = i;
+	}
+	
+	if (first > last)
+		return false;
+
+	num = h;
+	if (first)
+	{
+		uint32_t acc = h + first*dmin;
+		int k = acc / dmaj;
+		num = acc % dmaj;
+		na += ninc ? k : -k;
+		ma += minc ? (int)first : -(int)first;
+	}
+	mb = ma;
+	last -= first;
+	mb += minc ? (int)last : -(int)last;
+	return true;
+}
+
+/*
+  One line in GRAM coordinates through the run-slice kernels. Expects CS low
+  and the window set to the whole screen. mode is the entry mode currently in
+  reg 0x11, it is only rewritten when this line needs another one. With skip
+  set the first pixel is left out, it is the last pixel of the previous line
+  of a path.
+*/
+template <byte O>
+void UTFTBase::lineSegment(int xa, int ya, int xb, int yb, bool skip, word &mode)
+{
+	// clipping happens in GRAM coordinates, right in front of the kernels
+	int cx1=clip_x1, cy1=clip_y1, cx2=clip_x2, cy2=clip_y2;
+	
+	if (O==LANDSCAPE)
+	{
+		swap(int, xa, ya);
+		swap(int, xb, yb);
+		swap(int, cx1, cy1);
+		swap(int, cx2, cy2);
+	}		
+
+
+	uint16_t dx = abs(xb - xa);
+	uint16_t dy = abs(yb - ya);
+	bool xinc = xa < xb;
+	bool yinc = ya < yb;
+	uint16_t num, dmaj, dmin, count, major, minor;
+	
+	if ( dx < dy )
+	{
+		if (!clipLine(ya, xa, yb, dy, dx, yinc, xinc, cy1, cy2, cx1, cx2, skip, num))
+			return;
+		dmaj = dy;
+		dmin = dx;
+		count = abs(yb - ya) + 1;
+		major = ya;
+		minor = xa;
+	}
+	else
+	{
+		if (!clipLine(xa, ya, xb, dx, dy, xinc, yinc, cx1, cx2, cy1, cy2, skip, num))
+			return;
+		dmaj = dx;
+		dmin = dy;
+		count = abs(xb - xa) + 1;
+		major = xa;
+		minor = ya;
+	}
+	
+	// run-slice setup, dmaj = q*dmin + r; the first run ends at the first
+	// minor step after the (possibly clipped) start. Straight lines are a
+	// single run. dmaj is the unclipped length, the sums need 32 bits.
+	uint16_t q = 0, r = 0, run = count;
+	if (dmin)
+	{
+		q = dmaj / dmin;
+		r = dmaj % dmin;
+		run = ((uint32_t)dmaj - num + dmin - 1) / dmin;
+		num = (uint32_t)num + (uint32_t)run*dmin - dmaj;
+	}
+	
+	word em;
+	void (*kernel)(uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, uint16_t, uint16_t);
+	
+	if ( dx < dy ) 
+	{
+		if ( yinc )
+		{			
+			em = 0x6040|ID1|ID0|AM;
+			kernel = xinc ? fastlineAPP : fastlineANP;
+		}
+		else
+		{
+			em = 0x6040|ID0|AM;
+			kernel = xinc ? fastlineAPN : fastlineANN;
+		}			
+	}
+	else
+	{
+		if ( xinc )
+		{
+			em = 0x6040|ID1|ID0;
+			kernel = yinc ? fastlineBPP : fastlineBPN;
+		}
+		else
+		{
+			em = 0x6040|ID1;
+			kernel = yinc ? fastlineBNP : fastlineBNN;
+		}
+	}
+	
+	if (em != mode)
+	{
+		SSD1289_reg11(em);
+		mode = em;
+	}
+	SSD1289_setCursor(xa, ya);
+	SSD1289_dataFollows();
+	
+	kernel(fcl | fch << 8, major, minor, count, run, q, r, dmin, num);
+}
+
+template <byte O>
+void UTFTBase::drawLine(int xa, int ya, int xb, int yb)
+{
+	if (ya==yb)
+	{
+		drawHLine<O>(xa, ya, xb-xa);
+		return;
+	}			
+	if (xa==xb)
+	{
+		drawVLine<O>(xa, ya, yb-ya);
+		return;
+	}
+	
+	word mode = ENTRY_MODE(O);
+	
+	cbi(CS_PORT, CS_PIN);	
+	SSD1289_setWindow(0, 0, disp_x_size, disp_y_size);
+	lineSegment<O>(xa, ya, xb, yb, false, mode);
+	
+	// the line kernels pick their own entry mode, restore the one set by InitLCD
+	if (mode != ENTRY_MODE(O))
+	{
+		SSD1289_reg11(ENTRY_MODE(O));
+	}
+	sbi(CS_PORT, CS_PIN);
+	
+}	
+
+/*
+  Connected lines through the points of xy (x0, y0, x1, y1, ...), in RAM or
+  with pgm set in program memory. The whole path is one bus session: the
+  window is set once, the entry mode only when it changes, and every line
+  after the first starts one pixel in so shared corners are written once.
+  closed adds the line from the last point back to the first one.
+*/
+template <byte O>
+void UTFTBase::drawPath(const int *xy, int points, bool closed, bool pgm)
+{
+	if (points < 1)
+		return;
+	if (points < 3)
+		closed = false;
+	
+	int x0 = pgm ? (int)pgm_read_word(&xy[0]) : xy[0];
+	int y0 = pgm ? (int)pgm_read_word(&xy[1]) : xy[1];
+	int xa = x0, ya = y0;
+	word mode = ENTRY_MODE(O);
+	
+	cbi(CS_PORT, CS_PIN);
+	SSD1289_setWindow(0, 0, disp_x_size, disp_y_size);
+	
+	if (points == 1)
+		lineSegment<O>(xa, ya, xa, ya, false, mode);
+	
+	for (int i=1; i<points; i++)
+	{
+		int xb = pgm ? (int)pgm_read_word(&xy[2*i]) : xy[2*i];
+		int yb = pgm ? (int)pgm_read_word(&xy[2*i+1]) : xy[2*i+1];
+		
+		// a closed path starts with a skipped pixel too, the last line ends there
+		lineSegment<O>(xa, ya, xb, yb, closed || i>1, mode);
+		xa = xb;
+		ya = yb;
+	}
+	if (closed)
+		lineSegment<O>(xa, ya, x0, y0, true, mode);
+	
+	if (mode != ENTRY_MODE(O))
+	{
+		SSD1289_reg11(ENTRY_MODE(O));
+	}
+	sbi(CS_PORT, CS_PIN);
+}
+
+
+template <byte O>
+void UTFTBase::drawHLine(int x, int y, int l)
+{
+	if (l<0)
+	{
+		l = -l;
+		x -= l;
+	}
+	
+	int x2 = x+l;
+	int y2 = y;
+	if (!clipRect(x, y, x2, y2))
+		return;
+	
+	cbi(CS_PORT, CS_PIN);
+	
+	setXY<O>(x, y, x2, y);
+	_fast_fill_16(fch,fcl,x2-x+1);
+	sbi(CS_PORT, CS_PIN);
+}
+
+template <byte O>
+void UTFTBase::drawVLine(int x, int y, int l)
+{
+	if (l<0)
+	{
+		l = -l;
+		y -= l;
+	}
+	
+	int x2 = x;
+	int y2 = y+l;
+	if (!clipRect(x, y, x2, y2))
+		return;
+	
+	cbi(CS_PORT, CS_PIN);
+	setXY<O>(x, y, x, y2);
+	_fast_fill_16(fch,fcl,y2-y+1);
+	sbi(CS_PORT, CS_PIN);	
+
+}
+
+
+// One row of pixels from x1 to x2, nothing if x2 < x1. Expects CS low.
+template <byte O>
+void UTFTBase::fillSpan(int x1, int x2, int y)
+{
+	if (x2 < x1)
+		return;
+	
+	int y2 = y;
+	if (!clipRect(x1, y, x2, y2))
+		return;
+	
+	setXY<O>(x1, y, x2, y);
+	_fast_fill_16(fch,fcl,x2-x1+1);
+}
+
+template <byte O>
+void UTFTBase::printChar(byte c, int x, int y)
+{
+
+	word temp;
+	int x1 = x, y1 = y;
+	int x2 = x+cfont.x_size-1;
+	int y2 = y+cfont.y_size-1;
+
+	if (!clipRect(x1, y1, x2, y2))
+		return;
+
+	cbi(CS_PORT, CS_PIN);
+	
+	temp=((c-cfont.offset)*((cfont.x_size/8)*cfont.y_size))+4;
+
+	setXY<O>(x1, y1, x2, y2);
+	
+	if (x1==x && y1==y && x2==x+cfont.x_size-1 && y2==y+cfont.y_size-1)
+	{
+		fastbitmap_1bit(cfont.y_size * cfont.x_size/8, (uint16_t)cfont.font + temp,(fch<<8)|fcl,(bch<<8)|bcl);
+	}
+	else
+	{
+		byte stride = cfont.x_size/8;
+		
+		temp += (y1-y)*stride + (x1-x)/8;
+		fastbitmap_1bit_rect((uint16_t)cfont.font + temp, x2-x1+1, y2-y1+1, (x1-x)&7, stride, (fch<<8)|fcl, (bch<<8)|bcl);
+	}
+
+	sbi(CS_PORT, CS_PIN);
+	
+}
+
+template <byte O>
+void UTFTBase::rotateChar(byte c, int x, int y, int pos, int deg)
+{
+	byte i,j,ch;
+	word temp; 
+	int newx,newy;
+	double radian;
+	radian=deg*0.0175;  
+
+	cbi(CS_PORT, CS_PIN);
+
+	temp=((c-cfont.offset)*((cfont.x_size/8)*cfont.y_size))+4;
+	for(j=0;j<cfont.y_size;j++) 
+	{
+		for (int zz=0; zz<(cfont.x_size/8); zz++)
+		{
+			ch=pgm_read_byte(&cfont.font[temp+zz]); 
+			for(i=0;i<8;i++)
+			{   
+				newx=x+(((i+(zz*8)+(pos*cfont.x_size))*cos(radian))-((j)*sin(radian)));
+				newy=y+(((j)*cos(radian))+((i+(zz*8)+(pos*cfont.x_size))*sin(radian)));
+
+				if (!inClip(newx, newy))
+					continue;
+				
+				setXY<O>(newx,newy,newx+1,newy+1);
+				
+				if((ch&(1<<(7-i)))!=0)   
+				{
+					setPixel((fch<<8)|fcl);
+				} 
+				else  
+				{
+					setPixel((bch<<8)|bcl);
+				}   
+			}
+		}
+		temp+=(cfont.x_size/8);
+	}
+	sbi(CS_PORT, CS_PIN);
+}
+
+template <byte O>
+void UTFTBase::print(const char *st, int x, int y, int deg)
+{
+	int stl, i;
+
+	stl = strlen(st);
+
+	if (O==PORTRAIT)
+	{
+	if (x==RIGHT)
+		x=(disp_x_size+1)-(stl*cfont.x_size);
+	if (x==CENTER)
+		x=((disp_x_size+1)-(stl*cfont.x_size))/2;
+	}
+	else
+	{
+	if (x==RIGHT)
+		x=(disp_y_size+1)-(stl*cfont.x_size);
+	if (x==CENTER)
+		x=((disp_y_size+1)-(stl*cfont.x_size))/2;
+	}
+
+	for (i=0; i < stl; i++)
+		if (deg==0)
+			printChar<O>(*st++, x + (i*(cfont.x_size)), y);
+		else
+			rotateChar<O>(*st++, x, y, i, deg);
+}
+
+template <byte O>
+void UTFTBase::printWithMargin(const char *st, int x, int y, int limit)
+{
+	int stl, i;
+
+	stl = strlen(st);
+
+	if (O==PORTRAIT)
+	{
+		if (x==RIGHT)
+		x=(disp_x_size+1)-(stl*cfont.x_size);
+		if (x==CENTER)
+		x=((disp_x_size+1)-(stl*cfont.x_size))/2;
+	}
+	else
+	{
+		if (x==RIGHT)
+		x=(disp_y_size+1)-(stl*cfont.x_size);
+		if (x==CENTER)
+		x=((disp_y_size+1)-(stl*cfont.x_size))/2;
+	}
+
+	uint8_t indx = y;
+	for (i=0; i < stl; i++) {
+		if(i != 0 && (i % limit) == 0) indx += 12;
+		
+		printChar<O>(*st++, (x + ((i % limit)*(cfont.x_size))), indx);
+	}
+}
+
+
+template <byte O>
+void UTFTBase::printNumI(uint8_t num, int x, int y, int length, char filler)
+{
+	char buf[4];
+	char st[4];
+	bool neg=false;
+	int c=0, f=0;
+  
+	if (num==0)
+	{
+		if (length!=0)
+		{
+			for (c=0; c<(length-1); c++)
+				st[c]=filler;
+			st[c]=48;
+			st[c+1]=0;
+		}
+		else
+		{
+			st[0]=48;
+			st[1]=0;
+		}
+	}
+	else
+	{
+		while (num>0)
 		{
 			buf[c]=48+(num % 10);
 			c++;
@@ -684,314 +1702,1409 @@ void UTFT::printNumI(uint8_t num, int x, int y, int length, char filler)
 		}
 		buf[c]=0;
 	  
-		if (length>c)
+		if (length>c)
+		{
+			for (int i=0; i<(length-c); i++)
+			{
+				st[i+neg]=filler;
+				f++;
+			}
+		}
+
+		for (int i=c-1; i>=0; i--)
+		{
+			st[i+f]=buf[c-i-1];
+		}
+		st[c+f]=0;
+
+	}
+
+	print<O>(st,x,y,0);
+}
+
+template <byte O>
+void UTFTBase::printNumF(double num, byte dec, int x, int y, char divider, int length, char filler)
+{
+	char buf[25];
+	char st[27];
+	bool neg=false;
+	int c=0, f=0;
+	int c2;
+	long mult;
+	unsigned long inum;
+  
+	if (dec<1)
+	dec=1;
+	if (dec>5)
+	dec=5;
+	  
+	if (num==0)
+	{
+		if (length!=0)
+		{
+			for (c=0; c<(length-2-dec); c++)
+				st[c]=filler;
+			st[c]=48;
+			st[c+1]=divider;
+			for (int i=0; i<dec; i++)
+				st[c+2+i]=48;
+			st[c+2+dec]=0;
+		}
+		else
+		{
+			st[0]=48;
+			st[1]=divider;
+			for (int i=0; i<dec; i++)
+				st[2+i]=48;
+			st[2+dec]=0;
+		}
+	}
+	else
+	{
+		if (num<0)
+		{
+			neg=true;
+			num=-num;
+		}
+	  
+		mult = 1;
+		for (int j = 0; j < dec; j++)
+			mult = mult * 10;
+		inum=long(num*mult + 0.5);
+	  
+		while (inum>0)
+		{
+			buf[c]=48+(inum % 10);
+			c++;
+			inum=(inum-(inum % 10))/10;
+		}
+		if ((num<1) and (num>0))
+		{
+			buf[c]=48;
+			c++;
+		}
+		while (c<(dec+1))
+		{
+			buf[c]=48;
+			c++;
+		}
+		buf[c]=0;
+	  
+		if (neg)
+		{
+			st[0]=45;
+		}
+	  
+		if (length>(c+neg-1))
+		{
+			for (int i=0; i<(length-c-neg-1); i++)
+			{
+				st[i+neg]=filler;
+				f++;
+			}
+		}
+
+		c2=neg;
+		for (int i=0; i<c; i++)
+		{
+			st[c2+f]=buf[c-i-1];
+			c2++;
+			if ((c-(c2-neg))==dec)
+			{
+				st[c2+f]=divider;
+				c2++;
+			}
+		}
+		st[c2+f]=0;
+	}
+
+	print<O>(st,x,y,0);
+}
+
+void UTFTBase::setFont(const uint8_t* font)
+{
+	cfont.font=font;
+	cfont.x_size=fontbyte(0);
+	cfont.y_size=fontbyte(1);
+	cfont.offset=fontbyte(2);
+	cfont.numchars=fontbyte(3);
+}
+
+const uint8_t* UTFTBase::getFont()
+{
+	return cfont.font;
+}
+
+uint8_t UTFTBase::getFontXsize()
+{
+	return cfont.x_size;
+}
+
+uint8_t UTFTBase::getFontYsize()
+{
+	return cfont.y_size;
+}
+
+template <byte O>
+void UTFTBase::drawBitmap(int x, int y, int sx, int sy, const bitmapdatatype data, int scale)
+{
+	unsigned int col;
+	int tx, ty, tsx, tsy;
+	int x1 = x, y1 = y;
+	int x2 = x+(sx*scale)-1;
+	int y2 = y+(sy*scale)-1;
+
+	if (!clipRect(x1, y1, x2, y2))
+		return;
+
+	cbi(CS_PORT, CS_PIN);
+	setXY<O>(x1, y1, x2, y2);
+
+	if (scale==1)
+	{
+		if (x1==x && y1==y && x2==x+sx-1 && y2==y+sy-1)
+			fastbitmap_16bit(sx*sy, (const uint16_t)data);
+		else
+			fastbitmap_16bit_rect((const uint16_t)(data+((y1-y)*sx)+(x1-x)), x2-x1+1, y2-y1+1, (sx-(x2-x1+1))*2);
+	}
+	else
+	{
+		ty=(y1-y)/scale;
+		tsy=(y1-y)%scale;
+		for (int py=y1; py<=y2; py++)
+		{
+			tx=(x1-x)/scale;
+			tsx=(x1-x)%scale;
+			for (int px=x1; px<=x2; px++)
+			{
+				col=pgm_read_word(&data[(ty*sx)+tx]);
+				LCD_Write_DATA(col>>8,col & 0xff);
+				if (++tsx==scale)
+				{
+					tsx=0;
+					tx++;
+				}
+			}
+			if (++tsy==scale)
+			{
+				tsy=0;
+				ty++;
+			}
+		}
+	}
+	
+	sbi(CS_PORT, CS_PIN);
+}
+
+template <byte O>
+void UTFTBase::drawBitmapPB(int x, int y, int sx, int sy, const bitmapdatatype data)
+{
+	int x1 = x, y1 = y;
+	int x2 = x+sx-1;
+	int y2 = y+sy-1;
+
+	if (!clipRect(x1, y1, x2, y2))
+		return;
+
+	cbi(CS_PORT, CS_PIN);
+		
+	setXY<O>(x1, y1, x2, y2);
+
+	if (x1==x && y1==y && x2==x+sx-1 && y2==y+sy-1)
+	{
+		fastbitmap_pb565((const uint16_t)data);
+	}
+	else
+	{
+		// runs can not be skipped, decode them and only send the visible pixels
+		const uint8_t *p = (const uint8_t*)data;
+		int px = x, py = y;
+		byte n, ch = 0, cl = 0;
+		
+		while ((n=pgm_read_byte(p++))!=0 && py<=y2)
+		{
+			byte run = n & 0x80;
+			n &= 0x7F;
+			if (run)
+			{
+				ch=pgm_read_byte(p++);
+				cl=pgm_read_byte(p++);
+			}
+			while (n--)
+			{
+				if (!run)
+				{
+					ch=pgm_read_byte(p++);
+					cl=pgm_read_byte(p++);
+				}
+				if (py>=y1 && px>=x1 && px<=x2)
+					LCD_Write_DATA(ch,cl);
+				if (++px==x+sx)
+				{
+					px=x;
+					py++;
+				}
+			}
+		}
+	}
+		
+	sbi(CS_PORT, CS_PIN);
+}
+
+/*
+  Bitmaps in SRAM, e.g. a line composed at run time, stream through the
+  LD based kernels. 16 bit pixels are native words, as readRect returns
+  them. A 1 bit bitmap has byte aligned rows, most significant bit left,
+  and is drawn in the foreground and background colors.
+*/
+template <byte O>
+void UTFTBase::drawBitmapRAM(int x, int y, int sx, int sy, const word *data)
+{
+	int x1 = x, y1 = y;
+	int x2 = x+sx-1;
+	int y2 = y+sy-1;
+
+	if (!clipRect(x1, y1, x2, y2))
+		return;
+
+	cbi(CS_PORT, CS_PIN);
+	setXY<O>(x1, y1, x2, y2);
+	if (x1==x && x2==x+sx-1)
+		fastbitmap_16bit_ram(sx*(y2-y1+1), data+(y1-y)*sx);
+	else
+		for (int row=y1; row<=y2; row++)
+			fastbitmap_16bit_ram(x2-x1+1, data+(row-y)*sx+(x1-x));
+	sbi(CS_PORT, CS_PIN);
+}
+
+template <byte O>
+void UTFTBase::drawBitmapRAM(int x, int y, int sx, int sy, const uint8_t *bits)
+{
+	int x1 = x, y1 = y;
+	int x2 = x+sx-1;
+	int y2 = y+sy-1;
+	int stride = (sx+7)/8;
+
+	if (!clipRect(x1, y1, x2, y2))
+		return;
+
+	cbi(CS_PORT, CS_PIN);
+	setXY<O>(x1, y1, x2, y2);
+	if (!(sx&7) && x1==x && x2==x+sx-1)
+		fastbitmap_1bit_ram(stride*(y2-y1+1), bits+(y1-y)*stride, (fch<<8)|fcl, (bch<<8)|bcl);
+	else
+		fastbitmap_1bit_rect_ram(bits+(y1-y)*stride+((x1-x)>>3), x2-x1+1, y2-y1+1, (x1-x)&7, stride, (fch<<8)|fcl, (bch<<8)|bcl);
+	sbi(CS_PORT, CS_PIN);
+}
+
+/*
+  Draws a bitmap that arrives in pieces, from a UART buffer, serial flash
+  or EEPROM, without holding it in memory. source puts up to max bytes of
+  RGB565 pixels, low byte first, into buf and returns how many it gave, 0
+  ends the bitmap early. Chunks may split a pixel. The GRAM window stays
+  open across calls, so source must not draw on the display itself.
+*/
+template <byte O>
+void UTFTBase::drawBitmapStream(int x, int y, int sx, int sy, word (*source)(uint8_t *buf, word max))
+{
+	word buf[BITMAP_STREAM_CHUNK];
+	uint8_t *bytes = (uint8_t *)buf;
+	word have = 0;
+	int x1 = x, y1 = y;
+	int x2 = x+sx-1;
+	int y2 = y+sy-1;
+	int col = 0, row = 0;
+
+	if (!clipRect(x1, y1, x2, y2))
+		return;
+
+	cbi(CS_PORT, CS_PIN);
+	setXY<O>(x1, y1, x2, y2);
+	while (row<sy)
+	{
+		word n = source(bytes+have, sizeof(buf)-have);
+		if (!n)
+			break;
+		have += n;
+		
+		// whole pixels go out, the visible part of each row in one kernel call
+		const word *p = buf;
+		for (word left = have/2; left && row<sy; )
+		{
+			int seg = sx-col < (int)left ? sx-col : left;
+			int a = col > x1-x ? col : x1-x;
+			int b = col+seg-1 < x2-x ? col+seg-1 : x2-x;
+			
+			if (row>=y1-y && row<=y2-y && a<=b)
+				fastbitmap_16bit_ram(b-a+1, p+(a-col));
+			p += seg;
+			left -= seg;
+			col += seg;
+			if (col==sx)
+			{
+				col = 0;
+				row++;
+			}
+		}
+		
+		// half a pixel waits for the next chunk
+		if (have & 1)
+		{
+			bytes[0] = bytes[have-1];
+			have = 1;
+		}
+		else
+			have = 0;
+	}
+	sbi(CS_PORT, CS_PIN);
+}
+
+/*
+  Sprite with transparent pixels. The color key (or mask) is resolved when
+  the data is made, it is stored in program memory as runs of opaque pixels:
+    height                   one byte
+    for every row, runs of
+      skip                   one byte, transparent pixels before the run
+      count                  one byte, opaque pixels, 0 ends the row
+      count pixels           RGB565, high byte first
+  Nothing is compared at draw time and transparent pixels are never
+  written: each run is a cursor set and a fastbitmap_16bit burst.
+*/
+template <byte O>
+void UTFTBase::drawSprite(int x, int y, const uint8_t *sprite)
+{
+	const uint8_t *p = sprite;
+	byte sy = pgm_read_byte(p++);
+	
+	cbi(CS_PORT, CS_PIN);
+	SSD1289_setWindow(0, 0, disp_x_size, disp_y_size);
+	
+	for (int row=y; row<y+sy; row++)
+	{
+		bool visible = row>=clip_y1 && row<=clip_y2;
+		int col = x;
+		
+		for (;;)
+		{
+			col += pgm_read_byte(p++);
+			byte count = pgm_read_byte(p++);
+			if (!count)
+				break;
+			
+			int c1 = col > clip_x1 ? col : clip_x1;
+			int c2 = col+count-1 < clip_x2 ? col+count-1 : clip_x2;
+			
+			if (visible && c1<=c2)
+			{
+				if (O==LANDSCAPE)
+				{
+					SSD1289_setCursor(row, c1);
+				}
+				else
+				{
+					SSD1289_setCursor(c1, row);
+				}
+				SSD1289_dataFollows();
+				fastbitmap_16bit(c2-c1+1, (uint16_t)(p + 2*(c1-col)));
+			}
+			p += 2*count;
+			col += count;
+		}
+	}
+	
+	sbi(CS_PORT, CS_PIN);
+}
+
+/*
+  Reads the rectangle back from GRAM into buf, row by row, x2-x1+1 words
+  per row. Only the part on the screen is read, the words for pixels off
+  the edges are left as they were; the clip rectangle does not apply.
+*/
+template <byte O>
+void UTFTBase::readRect(int x1, int y1, int x2, int y2, word *buf)
+{
+	if (x1>x2)
+	{
+		swap(int, x1, x2);
+	}
+	if (y1>y2)
+	{
+		swap(int, y1, y2);
+	}
+	
+	int w = x2-x1+1;
+	int cx1 = x1 > 0 ? x1 : 0;
+	int cy1 = y1 > 0 ? y1 : 0;
+	int cx2 = x2 < getDisplayXSize<O>()-1 ? x2 : getDisplayXSize<O>()-1;
+	int cy2 = y2 < getDisplayYSize<O>()-1 ? y2 : getDisplayYSize<O>()-1;
+	
+	if (cx1>cx2 || cy1>cy2)
+		return;
+	
+	// one burst per row keeps the count within the kernel's 16 bits
+	buf += long(cy1-y1)*w + (cx1-x1);
+	cbi(CS_PORT, CS_PIN);
+	for (int row=cy1; row<=cy2; row++, buf+=w)
+	{
+		setXY<O>(cx1, row, cx2, row);
+		LCD_Read_GRAM(cx2-cx1+1, buf);
+	}
+	sbi(CS_PORT, CS_PIN);
+}
+
+template <byte O>
+word UTFTBase::readPixel(int x, int y)
+{
+	word c = 0;
+	readRect<O>(x, y, x, y, &c);
+	return c;
+}
+
+/*
+  Writes a buffer laid out like readRect's back to the rectangle, e.g. to
+  restore what was saved under a popup. Clipped like any other primitive.
+*/
+template <byte O>
+void UTFTBase::writeRect(int x1, int y1, int x2, int y2, const word *buf)
+{
+	drawBitmapRAM<O>(x1, y1, x2-x1+1, y2-y1+1, buf);
+}
+
+/*
+  Copies a rectangle of the screen to (dx, dy) through a small buffer on the
+  stack, in an order that also works when the two overlap.
+*/
+template <byte O>
+void UTFTBase::copyRect(int x1, int y1, int x2, int y2, int dx, int dy)
+{
+	const int chunk = 32;
+	word buf[chunk];
+	
+	if (x1>x2)
+	{
+		swap(int, x1, x2);
+	}
+	if (y1>y2)
+	{
+		swap(int, y1, y2);
+	}
+	
+	// source on the screen, destination in the clip rectangle
+	int xmax = getDisplayXSize<O>()-1;
+	int ymax = getDisplayYSize<O>()-1;
+	if (x1<0)             { dx -= x1; x1 = 0; }
+	if (y1<0)             { dy -= y1; y1 = 0; }
+	if (x2>xmax)          x2 = xmax;
+	if (y2>ymax)          y2 = ymax;
+	if (dx<clip_x1)       { x1 += clip_x1-dx; dx = clip_x1; }
+	if (dy<clip_y1)       { y1 += clip_y1-dy; dy = clip_y1; }
+	if (dx+x2-x1>clip_x2) x2 = x1 + clip_x2-dx;
+	if (dy+y2-y1>clip_y2) y2 = y1 + clip_y2-dy;
+	
+	if (x1>x2 || y1>y2)
+		return;
+	
+	bool up = dy <= y1;
+	bool left = dx <= x1;
+	
+	for (int i=0; i<=y2-y1; i++)
+	{
+		int sy = up ? y1+i : y2-i;
+		int ty = dy + (sy-y1);
+		
+		for (int j=0; j<=x2-x1; j+=chunk)
+		{
+			int n = x2-x1+1-j < chunk ? x2-x1+1-j : chunk;
+			int sx = left ? x1+j : x2-j-n+1;
+			
+			readRect<O>(sx, sy, sx+n-1, sy, buf);
+			writeRect<O>(dx + (sx-x1), ty, dx + (sx-x1) + n-1, ty, buf);
+		}
+	}
+}
+
+/*
+  Splits the part of the sx by sy rectangle at (ax,ay) that is not covered
+  by the same size rectangle at (bx,by) into at most two rectangles: a
+  full height column band and a row band over the shared columns.
+*/
+static byte spriteDiff(int ax, int ay, int bx, int by, int sx, int sy, int r[2][4])
+{
+	if (abs(bx-ax)>=sx || abs(by-ay)>=sy)
+	{
+		r[0][0] = ax; r[0][1] = ay; r[0][2] = ax+sx-1; r[0][3] = ay+sy-1;
+		return 1;
+	}
+	
+	byte n = 0;
+	int ox1 = ax>bx ? ax : bx;
+	int ox2 = (ax<bx ? ax : bx) + sx-1;
+	
+	if (bx!=ax)
+	{
+		r[n][0] = bx>ax ? ax : bx+sx;
+		r[n][2] = bx>ax ? bx-1 : ax+sx-1;
+		r[n][1] = ay; r[n][3] = ay+sy-1;
+		n++;
+	}
+	if (by!=ay)
+	{
+		r[n][1] = by>ay ? ay : by+sy;
+		r[n][3] = by>ay ? by-1 : ay+sy-1;
+		r[n][0] = ox1; r[n][2] = ox2;
+		n++;
+	}
+	return n;
+}
+
+/*
+  Saves a part of what lies under the sprite into its buffer, or puts it
+  back on screen from the buffer or through the background callback.
+*/
+template <byte O>
+void UTFTBase::spriteStrip(UTFTSprite &s, int x1, int y1, int x2, int y2, bool save)
+{
+	if (s.save)
+	{
+		for (int y=y1; y<=y2; y++)
+		{
+			word *p = s.save + (y-s.y)*s.sx + (x1-s.x);
+			if (save)
+				readRect<O>(x1, y, x2, y, p);
+			else
+				writeRect<O>(x1, y, x2, y, p);
+		}
+	}
+	else if (!save && s.background)
+	{
+		int cx1 = clip_x1, cy1 = clip_y1, cx2 = clip_x2, cy2 = clip_y2;
+		
+		if (clipRect(x1, y1, x2, y2))
+		{
+			clip_x1 = x1; clip_y1 = y1; clip_x2 = x2; clip_y2 = y2;
+			s.background(x1, y1, x2, y2);
+			clip_x1 = cx1; clip_y1 = cy1; clip_x2 = cx2; clip_y2 = cy2;
+		}
+	}
+}
+
+template <byte O>
+void UTFTBase::showSprite(UTFTSprite &s, int x, int y)
+{
+	if (s.visible)
+	{
+		moveSprite<O>(s, x, y);
+		return;
+	}
+	
+	s.x = x;
+	s.y = y;
+	s.visible = true;
+	spriteStrip<O>(s, x, y, x+s.sx-1, y+s.sy-1, true);
+	if (s.image)
+		drawBitmap<O>(x, y, s.sx, s.sy, s.image, 1);
+	else
+		fillRect<O>(x, y, x+s.sx-1, y+s.sy-1);
+}
+
+/*
+  Moves a sprite by touching only what changes: the strips it uncovers are
+  restored, the saved background is shifted along with it and only the
+  newly covered strips are read back. A solid sprite also paints just the
+  newly covered strips, an image sprite has to be redrawn whole.
+*/
+template <byte O>
+void UTFTBase::moveSprite(UTFTSprite &s, int x, int y)
+{
+	int r[2][4];
+	byte n;
+	
+	if (!s.visible)
+	{
+		showSprite<O>(s, x, y);
+		return;
+	}
+	if (x==s.x && y==s.y)
+		return;
+	
+	n = spriteDiff(s.x, s.y, x, y, s.sx, s.sy, r);
+	for (byte i=0; i<n; i++)
+		spriteStrip<O>(s, r[i][0], r[i][1], r[i][2], r[i][3], false);
+	
+	if (s.save && abs(x-s.x)<s.sx && abs(y-s.y)<s.sy)
+	{
+		int ox1 = x>s.x ? x : s.x;
+		int ox2 = (x<s.x ? x : s.x) + s.sx-1;
+		int oy1 = y>s.y ? y : s.y;
+		int oy2 = (y<s.y ? y : s.y) + s.sy-1;
+		
+		// rows move towards the start of the buffer when going down
+		for (int i=0; i<=oy2-oy1; i++)
 		{
-			for (int i=0; i<(length-c); i++)
+			int row = y>s.y ? oy1+i : oy2-i;
+			memmove(s.save + (row-y)*s.sx + (ox1-x), s.save + (row-s.y)*s.sx + (ox1-s.x), (ox2-ox1+1)*sizeof(word));
+		}
+	}
+	
+	n = spriteDiff(x, y, s.x, s.y, s.sx, s.sy, r);
+	s.x = x;
+	s.y = y;
+	for (byte i=0; i<n; i++)
+		spriteStrip<O>(s, r[i][0], r[i][1], r[i][2], r[i][3], true);
+	
+	if (s.image)
+		drawBitmap<O>(x, y, s.sx, s.sy, s.image, 1);
+	else
+		for (byte i=0; i<n; i++)
+			fillRect<O>(r[i][0], r[i][1], r[i][2], r[i][3]);
+}
+
+template <byte O>
+void UTFTBase::hideSprite(UTFTSprite &s)
+{
+	if (!s.visible)
+		return;
+	
+	spriteStrip<O>(s, s.x, s.y, s.x+s.sx-1, s.y+s.sy-1, false);
+	s.visible = false;
+}
+
+template <byte O>
+void UTFTBase::drawBitmap(int x, int y, int sx, int sy, const bitmapdatatype data, int deg, int rox, int roy)
+{
+	unsigned int col;
+	int tx, ty, newx, newy;
+	//byte r, g, b;
+	double radian;
+	radian=deg*0.0175;  
+
+	if (deg==0)
+		drawBitmap<O>(x, y, sx, sy, data, 1);
+	else
+	{
+		cbi(CS_PORT, CS_PIN);
+		for (ty=0; ty<sy; ty++)
+			for (tx=0; tx<sx; tx++)
 			{
-				st[i+neg]=filler;
-				f++;
+				col=pgm_read_word(&data[(ty*sx)+tx]);
+
+				newx=x+rox+(((tx-rox)*cos(radian))-((ty-roy)*sin(radian)));
+				newy=y+roy+(((ty-roy)*cos(radian))+((tx-rox)*sin(radian)));
+
+				if (inClip(newx, newy))
+				{
+					setXY<O>(newx, newy, newx, newy);
+					LCD_Write_DATA(col>>8,col & 0xff);
+				}
 			}
-		}
+		sbi(CS_PORT, CS_PIN);
+	}
+}
+
+void UTFTBase::lcdOff()
+{
+}
+
+void UTFTBase::lcdOn()
+{
+}
+
+void UTFTBase::setContrast(char c)
+{
+}
+
+// Device code read back when the panel was set up, SSD1289_ID if it
+// answered; anything else means init failed twice and nothing will show
+word UTFTBase::getDeviceID()
+{
+	return device_id;
+}
+
+/*
+  Hardware scrolling runs along the GRAM lines, the 320 pixel axis: y in
+  portrait, x in landscape. The lines first..last become the controller's
+  first screen; at offset n line first+n is shown at first and the area
+  wraps around, so moving it by n lines needs n lines of new pixels.
+*/
+void UTFTBase::setScrollArea(int first, int last)
+{
+	if (first>last)
+	{
+		swap(int, first, last);
+	}
+	if (first<0)
+		first=0;
+	if (last>disp_y_size)
+		last=disp_y_size;
+	
+	scroll_first=first;
+	scroll_last=last;
+	scroll_offset=0;
+	scroll_reg=0x41;
+	
+	cbi(CS_PORT, CS_PIN);
+	LCD_Write_COM_DATA(0x48, first);
+	LCD_Write_COM_DATA(0x49, last);
+	LCD_Write_COM_DATA(0x41, 0);
+	sbi(CS_PORT, CS_PIN);
+}
+
+/*
+  Keeps the lines first..last, which have to reach one end of the 320,
+  still on screen as one screen of the controller and makes the rest the
+  scroll area, driven as the other screen. A status bar drawn there stays
+  put while the body scrolls; both are drawn at their GRAM lines as mapped
+  by scrollLine. A strip touching neither end is refused and nothing is
+  changed.
+*/
+bool UTFTBase::setSplitScreen(int first, int last)
+{
+	if (first>last)
+	{
+		swap(int, first, last);
+	}
+	if ((first<=0 && last>=disp_y_size) || first>disp_y_size || last<0)
+	{
+		clrSplitScreen();
+		return true;
+	}
+	if (first>0 && last<disp_y_size)
+		return false;
+	
+	// the first screen has to be the one nearer line 0
+	word r07 = (SSD1289_R07 & ~VLE1) | SPT;
+	int split;
+	if (first<=0)
+	{
+		split=last;
+		scroll_first=last+1;
+		scroll_last=disp_y_size;
+		scroll_reg=0x42;
+		r07 |= VLE2;
+	}
+	else
+	{
+		split=first-1;
+		scroll_first=0;
+		scroll_last=first-1;
+		scroll_reg=0x41;
+		r07 |= VLE1;
+	}
+	scroll_offset=0;
+	
+	cbi(CS_PORT, CS_PIN);
+	LCD_Write_COM_DATA(0x48, 0);
+	LCD_Write_COM_DATA(0x49, split);
+	LCD_Write_COM_DATA(0x4A, split+1);
+	LCD_Write_COM_DATA(0x4B, disp_y_size);
+	LCD_Write_COM_DATA(0x41, 0);
+	LCD_Write_COM_DATA(0x42, 0);
+	SSD1289_reg07(r07);
+	sbi(CS_PORT, CS_PIN);
+	return true;
+}
+
+void UTFTBase::clrSplitScreen()
+{
+	cbi(CS_PORT, CS_PIN);
+	SSD1289_reg07(SSD1289_R07);
+	LCD_Write_COM_DATA(0x4A, 0);
+	LCD_Write_COM_DATA(0x4B, 0);
+	LCD_Write_COM_DATA(0x42, 0);
+	sbi(CS_PORT, CS_PIN);
+	setScrollArea(0, disp_y_size);
+}
+
+void UTFTBase::scrollTo(int offset)
+{
+	int h = scroll_last-scroll_first+1;
+	
+	offset %= h;
+	if (offset<0)
+		offset += h;
+	scroll_offset=offset;
+	
+	cbi(CS_PORT, CS_PIN);
+	LCD_Write_COM_DATA(scroll_reg, offset);
+	sbi(CS_PORT, CS_PIN);
+}
+
+// The GRAM line to draw at for what should show on screen line line
+int UTFTBase::scrollLine(int line)
+{
+	if (line<scroll_first || line>scroll_last)
+		return line;
+	
+	int h = scroll_last-scroll_first+1;
+	int l = line-scroll_first+scroll_offset;
+	return scroll_first + (l>=h ? l-h : l);
+}
+
+/*
+  Repaints GRAM lines first..last through the callback, with the clip
+  rectangle narrowed to them, or clears them to the back color.
+*/
+template <byte O>
+void UTFTBase::repaintLines(int first, int last, void (*repaint)(int first, int last))
+{
+	int cx1 = clip_x1, cy1 = clip_y1, cx2 = clip_x2, cy2 = clip_y2;
+	int x1 = 0, y1 = 0, x2 = getDisplayXSize<O>()-1, y2 = getDisplayYSize<O>()-1;
+	
+	if (O==LANDSCAPE)
+	{
+		x1 = first;
+		x2 = last;
+	}
+	else
+	{
+		y1 = first;
+		y2 = last;
+	}
+	
+	if (clipRect(x1, y1, x2, y2))
+	{
+		clip_x1 = x1; clip_y1 = y1; clip_x2 = x2; clip_y2 = y2;
+		if (repaint)
+			repaint(first, last);
+		else
+			fillScr<O>((bch<<8)|bcl);
+		clip_x1 = cx1; clip_y1 = cy1; clip_x2 = cx2; clip_y2 = cy2;
+	}
+}
+
+/*
+  Scrolls the area by lines (positive moves the content towards line 0)
+  and repaints only the GRAM lines that come into view.
+*/
+template <byte O>
+void UTFTBase::scroll(int lines, void (*repaint)(int first, int last))
+{
+	int h = scroll_last-scroll_first+1;
+	int from = scroll_offset;
+	
+	if (!lines)
+		return;
+	
+	scrollTo(scroll_offset+lines);
+	if (lines>=h || lines<=-h)
+	{
+		repaintLines<O>(scroll_first, scroll_last, repaint);
+		return;
+	}
+	
+	if (lines<0)
+	{
+		from = scroll_offset;
+		lines = -lines;
+	}
+	if (from+lines>h)
+	{
+		repaintLines<O>(scroll_first+from, scroll_last, repaint);
+		repaintLines<O>(scroll_first, scroll_first+from+lines-h-1, repaint);
+	}
+	else
+		repaintLines<O>(scroll_first+from, scroll_first+from+lines-1, repaint);
+}
+
+template <byte O>
+int UTFTBase::getDisplayXSize()
+{
+	if (O==PORTRAIT)
+		return disp_x_size+1;
+	else
+		return disp_y_size+1;
+}
+
+template <byte O>
+int UTFTBase::getDisplayYSize()
+{
+	if (O==PORTRAIT)
+		return disp_y_size+1;
+	else
+		return disp_x_size+1;
+}
+
+
+#define UTFT_INSTANTIATE(O)\
+	template void UTFTBase::clrScr<O>();\
+	template void UTFTBase::fillScr<O>(byte, byte, byte);\
+	template void UTFTBase::fillScr<O>(word);\
+	template void UTFTBase::setClipRect<O>(int, int, int, int);\
+	template void UTFTBase::clrClipRect<O>();\
+	template void UTFTBase::drawPixel<O>(int, int);\
+	template void UTFTBase::drawLine<O>(int, int, int, int);\
+	template void UTFTBase::drawPath<O>(const int *, int, bool, bool);\
+	template void UTFTBase::drawLine<O>(int, int, int, int, int);\
+	template void UTFTBase::drawRect<O>(int, int, int, int);\
+	template void UTFTBase::drawRect<O>(int, int, int, int, int);\
+	template void UTFTBase::drawRoundRect<O>(int, int, int, int);\
+	template void UTFTBase::fillRect<O>(int, int, int, int);\
+	template void UTFTBase::fillRoundRect<O>(int, int, int, int);\
+	template void UTFTBase::fillRectMasked<O>(int, int, int, int, word);\
+	template void UTFTBase::tintRect<O>(int, int, int, int, word);\
+	template void UTFTBase::fillRectPattern<O>(int, int, int, int, const uint8_t *, byte);\
+	template void UTFTBase::fillRectGradient<O>(int, int, int, int, const word *, byte, bool, bool);\
+	template void UTFTBase::fillTriangle<O>(int, int, int, int, int, int);\
+	template void UTFTBase::fillPolygon<O>(const int *, int, bool, bool);\
+	template void UTFTBase::drawCircle<O>(int, int, int);\
+	template void UTFTBase::drawCircle<O>(int, int, int, int);\
+	template void UTFTBase::ellipse<O>(int, int, int, int, bool);\
+	template void UTFTBase::fillArc<O>(int, int, int, int, int, int);\
+	template void UTFTBase::fillCircle<O>(int, int, int);\
+	template void UTFTBase::print<O>(const char *, int, int, int);\
+	template void UTFTBase::printWithMargin<O>(const char *, int, int, int);\
+	template void UTFTBase::printNumI<O>(uint8_t, int, int, int, char);\
+	template void UTFTBase::printNumF<O>(double, byte, int, int, char, int, char);\
+	template void UTFTBase::drawBitmap<O>(int, int, int, int, const bitmapdatatype, int);\
+	template void UTFTBase::drawBitmapPB<O>(int, int, int, int, const bitmapdatatype);\
+	template void UTFTBase::drawBitmapRAM<O>(int, int, int, int, const word *);\
+	template void UTFTBase::drawBitmapRAM<O>(int, int, int, int, const uint8_t *);\
+	template void UTFTBase::drawBitmapStream<O>(int, int, int, int, word (*)(uint8_t *, word));\
+	template void UTFTBase::drawSprite<O>(int, int, const uint8_t *);\
+	template void UTFTBase::readRect<O>(int, int, int, int, word *);\
+	template word UTFTBase::readPixel<O>(int, int);\
+	template void UTFTBase::writeRect<O>(int, int, int, int, const word *);\
+	template void UTFTBase::copyRect<O>(int, int, int, int, int, int);\
+	template void UTFTBase::showSprite<O>(UTFTSprite &, int, int);\
+	template void UTFTBase::moveSprite<O>(UTFTSprite &, int, int);\
+	template void UTFTBase::hideSprite<O>(UTFTSprite &);\
+	template void UTFTBase::scroll<O>(int, void (*)(int, int));\
+	template void UTFTBase::drawBitmap<O>(int, int, int, int, const bitmapdatatype, int, int, int);\
+	template int  UTFTBase::getDisplayXSize<O>();\
+	template int  UTFTBase::getDisplayYSize<O>();
+
+UTFT_INSTANTIATE(PORTRAIT)
+UTFT_INSTANTIATE(LANDSCAPE)
+
+
+// Runtime orientation wrapper, see UTFT.h
+
+void UTFT::InitLCD(byte orientation)
+{
+	orient=orientation;
+	UTFTBase::InitLCD(orientation);
+}
+
+void UTFT::clrScr()
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::clrScr<LANDSCAPE>();
+	else
+		UTFTBase::clrScr<PORTRAIT>();
+}
+
+void UTFT::fillScr(byte r, byte g, byte b)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::fillScr<LANDSCAPE>(r, g, b);
+	else
+		UTFTBase::fillScr<PORTRAIT>(r, g, b);
+}
+
+void UTFT::fillScr(word color)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::fillScr<LANDSCAPE>(color);
+	else
+		UTFTBase::fillScr<PORTRAIT>(color);
+}
+
+void UTFT::setClipRect(int x1, int y1, int x2, int y2)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::setClipRect<LANDSCAPE>(x1, y1, x2, y2);
+	else
+		UTFTBase::setClipRect<PORTRAIT>(x1, y1, x2, y2);
+}
+
+void UTFT::clrClipRect()
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::clrClipRect<LANDSCAPE>();
+	else
+		UTFTBase::clrClipRect<PORTRAIT>();
+}
+
+void UTFT::drawPixel(int x, int y)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::drawPixel<LANDSCAPE>(x, y);
+	else
+		UTFTBase::drawPixel<PORTRAIT>(x, y);
+}
+
+void UTFT::drawLine(int x1, int y1, int x2, int y2)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::drawLine<LANDSCAPE>(x1, y1, x2, y2);
+	else
+		UTFTBase::drawLine<PORTRAIT>(x1, y1, x2, y2);
+}
+
+void UTFT::drawLine(int x1, int y1, int x2, int y2, int width)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::drawLine<LANDSCAPE>(x1, y1, x2, y2, width);
+	else
+		UTFTBase::drawLine<PORTRAIT>(x1, y1, x2, y2, width);
+}
+
+void UTFT::drawPolyline(const int *xy, int points)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::drawPath<LANDSCAPE>(xy, points, false, false);
+	else
+		UTFTBase::drawPath<PORTRAIT>(xy, points, false, false);
+}
+
+void UTFT::drawPolygon(const int *xy, int points)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::drawPath<LANDSCAPE>(xy, points, true, false);
+	else
+		UTFTBase::drawPath<PORTRAIT>(xy, points, true, false);
+}
+
+void UTFT::drawPolylineP(const int *xy, int points)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::drawPath<LANDSCAPE>(xy, points, false, true);
+	else
+		UTFTBase::drawPath<PORTRAIT>(xy, points, false, true);
+}
+
+void UTFT::drawPolygonP(const int *xy, int points)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::drawPath<LANDSCAPE>(xy, points, true, true);
+	else
+		UTFTBase::drawPath<PORTRAIT>(xy, points, true, true);
+}
+
+void UTFT::drawRect(int x1, int y1, int x2, int y2)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::drawRect<LANDSCAPE>(x1, y1, x2, y2);
+	else
+		UTFTBase::drawRect<PORTRAIT>(x1, y1, x2, y2);
+}
+
+void UTFT::drawRect(int x1, int y1, int x2, int y2, int width)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::drawRect<LANDSCAPE>(x1, y1, x2, y2, width);
+	else
+		UTFTBase::drawRect<PORTRAIT>(x1, y1, x2, y2, width);
+}
+
+void UTFT::drawRoundRect(int x1, int y1, int x2, int y2)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::drawRoundRect<LANDSCAPE>(x1, y1, x2, y2);
+	else
+		UTFTBase::drawRoundRect<PORTRAIT>(x1, y1, x2, y2);
+}
+
+void UTFT::fillRect(int x1, int y1, int x2, int y2)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::fillRect<LANDSCAPE>(x1, y1, x2, y2);
+	else
+		UTFTBase::fillRect<PORTRAIT>(x1, y1, x2, y2);
+}
+
+void UTFT::fillRoundRect(int x1, int y1, int x2, int y2)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::fillRoundRect<LANDSCAPE>(x1, y1, x2, y2);
+	else
+		UTFTBase::fillRoundRect<PORTRAIT>(x1, y1, x2, y2);
+}
+
+void UTFT::fillRectMasked(int x1, int y1, int x2, int y2, word mask)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::fillRectMasked<LANDSCAPE>(x1, y1, x2, y2, mask);
+	else
+		UTFTBase::fillRectMasked<PORTRAIT>(x1, y1, x2, y2, mask);
+}
+
+void UTFT::tintRect(int x1, int y1, int x2, int y2, word color)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::tintRect<LANDSCAPE>(x1, y1, x2, y2, color);
+	else
+		UTFTBase::tintRect<PORTRAIT>(x1, y1, x2, y2, color);
+}
+
+void UTFT::fillRectPattern(int x1, int y1, int x2, int y2, const uint8_t *pattern, byte size)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::fillRectPattern<LANDSCAPE>(x1, y1, x2, y2, pattern, size);
+	else
+		UTFTBase::fillRectPattern<PORTRAIT>(x1, y1, x2, y2, pattern, size);
+}
 
-		for (int i=c-1; i>=0; i--)
-		{
-			st[i+f]=buf[c-i-1];
-		}
-		st[c+f]=0;
+void UTFT::fillRectGradient(int x1, int y1, int x2, int y2, word c1, word c2, bool horizontal, bool dither)
+{
+	word colors[2] = { c1, c2 };
 
-	}
+	if (orient & LANDSCAPE)
+		UTFTBase::fillRectGradient<LANDSCAPE>(x1, y1, x2, y2, colors, 2, horizontal, dither);
+	else
+		UTFTBase::fillRectGradient<PORTRAIT>(x1, y1, x2, y2, colors, 2, horizontal, dither);
+}
 
-	print(st,x,y);
+void UTFT::fillRectGradientStops(int x1, int y1, int x2, int y2, const word *colors, byte stops, bool horizontal, bool dither)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::fillRectGradient<LANDSCAPE>(x1, y1, x2, y2, colors, stops, horizontal, dither);
+	else
+		UTFTBase::fillRectGradient<PORTRAIT>(x1, y1, x2, y2, colors, stops, horizontal, dither);
 }
 
-void UTFT::printNumF(double num, byte dec, int x, int y, char divider, int length, char filler)
+void UTFT::fillTriangle(int x1, int y1, int x2, int y2, int x3, int y3)
 {
-	char buf[25];
-	char st[27];
-	bool neg=false;
-	int c=0, f=0;
-	int c2;
-	long mult;
-	unsigned long inum;
-  
-	if (dec<1)
-	dec=1;
-	if (dec>5)
-	dec=5;
-	  
-	if (num==0)
-	{
-		if (length!=0)
-		{
-			for (c=0; c<(length-2-dec); c++)
-				st[c]=filler;
-			st[c]=48;
-			st[c+1]=divider;
-			for (int i=0; i<dec; i++)
-				st[c+2+i]=48;
-			st[c+2+dec]=0;
-		}
-		else
-		{
-			st[0]=48;
-			st[1]=divider;
-			for (int i=0; i<dec; i++)
-				st[2+i]=48;
-			st[2+dec]=0;
-		}
-	}
+	if (orient & LANDSCAPE)
+		UTFTBase::fillTriangle<LANDSCAPE>(x1, y1, x2, y2, x3, y3);
 	else
-	{
-		if (num<0)
-		{
-			neg=true;
-			num=-num;
-		}
-	  
-		mult = 1;
-		for (int j = 0; j < dec; j++)
-			mult = mult * 10;
-		inum=long(num*mult + 0.5);
-	  
-		while (inum>0)
-		{
-			buf[c]=48+(inum % 10);
-			c++;
-			inum=(inum-(inum % 10))/10;
-		}
-		if ((num<1) and (num>0))
-		{
-			buf[c]=48;
-			c++;
-		}
-		while (c<(dec+1))
-		{
-			buf[c]=48;
-			c++;
-		}
-		buf[c]=0;
-	  
-		if (neg)
-		{
-			st[0]=45;
-		}
-	  
-		if (length>(c+neg-1))
-		{
-			for (int i=0; i<(length-c-neg-1); i++)
-			{
-				st[i+neg]=filler;
-				f++;
-			}
-		}
+		UTFTBase::fillTriangle<PORTRAIT>(x1, y1, x2, y2, x3, y3);
+}
 
-		c2=neg;
-		for (int i=0; i<c; i++)
-		{
-			st[c2+f]=buf[c-i-1];
-			c2++;
-			if ((c-(c2-neg))==dec)
-			{
-				st[c2+f]=divider;
-				c2++;
-			}
-		}
-		st[c2+f]=0;
-	}
+void UTFT::fillPolygon(const int *xy, int points, bool nonzero)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::fillPolygon<LANDSCAPE>(xy, points, nonzero, false);
+	else
+		UTFTBase::fillPolygon<PORTRAIT>(xy, points, nonzero, false);
+}
 
-	print(st,x,y);
+void UTFT::fillPolygonP(const int *xy, int points, bool nonzero)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::fillPolygon<LANDSCAPE>(xy, points, nonzero, true);
+	else
+		UTFTBase::fillPolygon<PORTRAIT>(xy, points, nonzero, true);
 }
 
-void UTFT::setFont(const uint8_t* font)
+void UTFT::drawCircle(int x, int y, int radius)
 {
-	cfont.font=font;
-	cfont.x_size=fontbyte(0);
-	cfont.y_size=fontbyte(1);
-	cfont.offset=fontbyte(2);
-	cfont.numchars=fontbyte(3);
+	if (orient & LANDSCAPE)
+		UTFTBase::drawCircle<LANDSCAPE>(x, y, radius);
+	else
+		UTFTBase::drawCircle<PORTRAIT>(x, y, radius);
 }
 
-const uint8_t* UTFT::getFont()
+void UTFT::drawCircle(int x, int y, int radius, int width)
 {
-	return cfont.font;
+	if (orient & LANDSCAPE)
+		UTFTBase::drawCircle<LANDSCAPE>(x, y, radius, width);
+	else
+		UTFTBase::drawCircle<PORTRAIT>(x, y, radius, width);
 }
 
-uint8_t UTFT::getFontXsize()
+void UTFT::drawEllipse(int x, int y, int rx, int ry)
 {
-	return cfont.x_size;
+	if (orient & LANDSCAPE)
+		UTFTBase::ellipse<LANDSCAPE>(x, y, rx, ry, false);
+	else
+		UTFTBase::ellipse<PORTRAIT>(x, y, rx, ry, false);
 }
 
-uint8_t UTFT::getFontYsize()
+void UTFT::fillEllipse(int x, int y, int rx, int ry)
 {
-	return cfont.y_size;
+	if (orient & LANDSCAPE)
+		UTFTBase::ellipse<LANDSCAPE>(x, y, rx, ry, true);
+	else
+		UTFTBase::ellipse<PORTRAIT>(x, y, rx, ry, true);
 }
 
-void UTFT::drawBitmap(int x, int y, int sx, int sy, const bitmapdatatype data, int scale)
+void UTFT::drawArc(int x, int y, int radius, int start, int end)
 {
-	unsigned int col;
-	int tx, ty, tsx, tsy;
+	if (orient & LANDSCAPE)
+		UTFTBase::fillArc<LANDSCAPE>(x, y, radius-1, radius, start, end);
+	else
+		UTFTBase::fillArc<PORTRAIT>(x, y, radius-1, radius, start, end);
+}
 
-	if (scale==1)
-	{
-		if (orient==PORTRAIT)
-		{
-			cbi(CS_PORT, CS_PIN);
-			
-			SSD1289_setXY(x,y, x+sx-1, y+sy-1, x, y);
-			SSD1289_reg11(0x6040 |ID0|ID1);
-			SSD1289_dataFollows();
+void UTFT::fillArc(int x, int y, int r1, int r2, int start, int end)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::fillArc<LANDSCAPE>(x, y, r1, r2, start, end);
+	else
+		UTFTBase::fillArc<PORTRAIT>(x, y, r1, r2, start, end);
+}
 
-			fastbitmap_16bit(sx*sy, (const uint16_t)data);
-			
-			sbi(CS_PORT, CS_PIN);
-		}
-		else
-		{
-			cbi(CS_PORT, CS_PIN);
-			
-			swap(uint16_t, x, y);
-			swap(uint16_t, sx,sy);			
-			y=disp_y_size-y;			
-						
-			SSD1289_setXY( x, y - (sy -1),  ( x + sx - 1 ),y,x, y - (sy-1) );
-			SSD1289_reg11(0x6040 |ID0|AM);
-			SSD1289_dataFollows();
+void UTFT::fillCircle(int x, int y, int radius)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::fillCircle<LANDSCAPE>(x, y, radius);
+	else
+		UTFTBase::fillCircle<PORTRAIT>(x, y, radius);
+}
 
-			fastbitmap_16bit(sx*sy, (const uint16_t)data);
-			
-			sbi(CS_PORT, CS_PIN);
-		}
-	}
+void UTFT::print(const char *st, int x, int y, int deg)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::print<LANDSCAPE>(st, x, y, deg);
 	else
-	{
-		if (orient==PORTRAIT)
-		{
-			cbi(CS_PORT, CS_PIN);
-			for (ty=0; ty<sy; ty++)
-			{
-				setXY(x, y+(ty*scale), x+((sx*scale)-1), y+(ty*scale)+scale);
-				for (tsy=0; tsy<scale; tsy++)
-					for (tx=0; tx<sx; tx++)
-					{
-						col=pgm_read_word(&data[(ty*sx)+tx]);
-						for (tsx=0; tsx<scale; tsx++)
-							LCD_Write_DATA(col>>8,col & 0xff);
-					}
-			}
-			sbi(CS_PORT, CS_PIN);
-		}
-		else
-		{
-			cbi(CS_PORT, CS_PIN);
-			for (ty=0; ty<sy; ty++)
-			{
-				for (tsy=0; tsy<scale; tsy++)
-				{
-					setXY(x, y+(ty*scale)+tsy, x+((sx*scale)-1), y+(ty*scale)+tsy);
-					for (tx=sx; tx>=0; tx--)
-					{
-						col=pgm_read_word(&data[(ty*sx)+tx]);
-						for (tsx=0; tsx<scale; tsx++)
-							LCD_Write_DATA(col>>8,col & 0xff);
-					}
-				}
-			}
-			sbi(CS_PORT, CS_PIN);
-		}
-	}
+		UTFTBase::print<PORTRAIT>(st, x, y, deg);
+}
+
+void UTFT::printWithMargin(const char *st, int x, int y, int limit)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::printWithMargin<LANDSCAPE>(st, x, y, limit);
+	else
+		UTFTBase::printWithMargin<PORTRAIT>(st, x, y, limit);
+}
+
+void UTFT::printNumI(uint8_t num, int x, int y, int length, char filler)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::printNumI<LANDSCAPE>(num, x, y, length, filler);
+	else
+		UTFTBase::printNumI<PORTRAIT>(num, x, y, length, filler);
+}
+
+void UTFT::printNumF(double num, byte dec, int x, int y, char divider, int length, char filler)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::printNumF<LANDSCAPE>(num, dec, x, y, divider, length, filler);
+	else
+		UTFTBase::printNumF<PORTRAIT>(num, dec, x, y, divider, length, filler);
+}
+
+void UTFT::drawBitmap(int x, int y, int sx, int sy, const bitmapdatatype data, int scale)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::drawBitmap<LANDSCAPE>(x, y, sx, sy, data, scale);
+	else
+		UTFTBase::drawBitmap<PORTRAIT>(x, y, sx, sy, data, scale);
 }
 
 void UTFT::drawBitmapPB(int x, int y, int sx, int sy, const bitmapdatatype data)
 {
-	//unsigned int col;
-	//int tx, ty, tc, tsx, tsy;
-	//byte r, g, b;
+	if (orient & LANDSCAPE)
+		UTFTBase::drawBitmapPB<LANDSCAPE>(x, y, sx, sy, data);
+	else
+		UTFTBase::drawBitmapPB<PORTRAIT>(x, y, sx, sy, data);
+}
 
+void UTFT::drawBitmapRAM(int x, int y, int sx, int sy, const word *data)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::drawBitmapRAM<LANDSCAPE>(x, y, sx, sy, data);
+	else
+		UTFTBase::drawBitmapRAM<PORTRAIT>(x, y, sx, sy, data);
+}
 
-	if (orient==PORTRAIT)
-	{
-		cbi(CS_PORT, CS_PIN);
-		
-		SSD1289_setXY(x,y, x+sx-1, y+sy-1, x, y);
-		SSD1289_reg11(0x6040 |ID0|ID1);
-		SSD1289_dataFollows();
+void UTFT::drawBitmapRAM(int x, int y, int sx, int sy, const uint8_t *bits)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::drawBitmapRAM<LANDSCAPE>(x, y, sx, sy, bits);
+	else
+		UTFTBase::drawBitmapRAM<PORTRAIT>(x, y, sx, sy, bits);
+}
 
-		fastbitmap_pb565((const uint16_t)data);
-		
-		sbi(CS_PORT, CS_PIN);
-	}
+void UTFT::drawBitmapStream(int x, int y, int sx, int sy, word (*source)(uint8_t *buf, word max))
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::drawBitmapStream<LANDSCAPE>(x, y, sx, sy, source);
 	else
-	{
-		cbi(CS_PORT, CS_PIN);
-		
-		swap(uint16_t, x, y);
-		swap(uint16_t, sx,sy);
-		y=disp_y_size-y;
-		
-		SSD1289_setXY( x, y - (sy -1),  ( x + sx - 1 ),y,x, y - (sy-1) );
-		SSD1289_reg11(0x6040 |ID0|AM);
-		SSD1289_dataFollows();
+		UTFTBase::drawBitmapStream<PORTRAIT>(x, y, sx, sy, source);
+}
 
-		fastbitmap_pb565((const uint16_t)data);
-		
-		sbi(CS_PORT, CS_PIN);
-	}
+void UTFT::drawSprite(int x, int y, const uint8_t *sprite)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::drawSprite<LANDSCAPE>(x, y, sprite);
+	else
+		UTFTBase::drawSprite<PORTRAIT>(x, y, sprite);
+}
 
-	
+void UTFT::readRect(int x1, int y1, int x2, int y2, word *buf)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::readRect<LANDSCAPE>(x1, y1, x2, y2, buf);
+	else
+		UTFTBase::readRect<PORTRAIT>(x1, y1, x2, y2, buf);
 }
 
-void UTFT::drawBitmap(int x, int y, int sx, int sy, const bitmapdatatype data, int deg, int rox, int roy)
+word UTFT::readPixel(int x, int y)
 {
-	unsigned int col;
-	int tx, ty, newx, newy;
-	//byte r, g, b;
-	double radian;
-	radian=deg*0.0175;  
+	if (orient & LANDSCAPE)
+		return UTFTBase::readPixel<LANDSCAPE>(x, y);
+	else
+		return UTFTBase::readPixel<PORTRAIT>(x, y);
+}
 
-	if (deg==0)
-		drawBitmap(x, y, sx, sy, data);
+void UTFT::writeRect(int x1, int y1, int x2, int y2, const word *buf)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::writeRect<LANDSCAPE>(x1, y1, x2, y2, buf);
 	else
-	{
-		cbi(CS_PORT, CS_PIN);
-		for (ty=0; ty<sy; ty++)
-			for (tx=0; tx<sx; tx++)
-			{
-				col=pgm_read_word(&data[(ty*sx)+tx]);
+		UTFTBase::writeRect<PORTRAIT>(x1, y1, x2, y2, buf);
+}
 
-				newx=x+rox+(((tx-rox)*cos(radian))-((ty-roy)*sin(radian)));
-				newy=y+roy+(((ty-roy)*cos(radian))+((tx-rox)*sin(radian)));
+void UTFT::copyRect(int x1, int y1, int x2, int y2, int dx, int dy)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::copyRect<LANDSCAPE>(x1, y1, x2, y2, dx, dy);
+	else
+		UTFTBase::copyRect<PORTRAIT>(x1, y1, x2, y2, dx, dy);
+}
 
-				setXY(newx, newy, newx, newy);
-				LCD_Write_DATA(col>>8,col & 0xff);
-			}
-		sbi(CS_PORT, CS_PIN);
-	}
+void UTFT::showSprite(UTFTSprite &s, int x, int y)
+{
+	if (orient & LANDSCAPE)
+		UTFTBase::showSprite<LANDSCAPE>(s, x, y);
+	else
+		UTFTBase::showSprite<PORTRAIT>(s, x, y);
 }
 
-void UTFT::lcdOff()
+void UTFT::moveSprite(UTFTSprite &s, int x, int y)
 {
+	if (orient & LANDSCAPE)
+		UTFTBase::moveSprite<LANDSCAPE>(s, x, y);
+	else
+		UTFTBase::moveSprite<PORTRAIT>(s, x, y);
 }
 
-void UTFT::lcdOn()
+void UTFT::hideSprite(UTFTSprite &s)
 {
+	if (orient & LANDSCAPE)
+		UTFTBase::hideSprite<LANDSCAPE>(s);
+	else
+		UTFTBase::hideSprite<PORTRAIT>(s);
 }
 
-void UTFT::setContrast(char c)
+void UTFT::scroll(int lines, void (*repaint)(int first, int last))
 {
+	if (orient & LANDSCAPE)
+		UTFTBase::scroll<LANDSCAPE>(lines, repaint);
+	else
+		UTFTBase::scroll<PORTRAIT>(lines, repaint);
 }
 
-int UTFT::getDisplayXSize()
+void UTFT::drawBitmap(int x, int y, int sx, int sy, const bitmapdatatype data, int deg, int rox, int roy)
 {
-	if (orient==PORTRAIT)
-		return disp_x_size+1;
+	if (orient & LANDSCAPE)
+		UTFTBase::drawBitmap<LANDSCAPE>(x, y, sx, sy, data, deg, rox, roy);
 	else
-		return disp_y_size+1;
+		UTFTBase::drawBitmap<PORTRAIT>(x, y, sx, sy, data, deg, rox, roy);
+}
+
+int UTFT::getDisplayXSize()
+{
+	if (orient & LANDSCAPE)
+		return UTFTBase::getDisplayXSize<LANDSCAPE>();
+	return UTFTBase::getDisplayXSize<PORTRAIT>();
 }
 
 int UTFT::getDisplayYSize()
 {
-	if (orient==PORTRAIT)
-		return disp_y_size+1;
-	else
-		return disp_x_size+1;
+	if (orient & LANDSCAPE)
+		return UTFTBase::getDisplayYSize<LANDSCAPE>();
+	return UTFTBase::getDisplayYSize<PORTRAIT>();
 }
@@ -58,8 +58,34 @@
 #define RIGHT 9999
 #define CENTER 9998
 
+// Most points fillPolygon takes, each costs about 22 bytes of stack
+#ifndef POLYGON_MAX_POINTS
+#define POLYGON_MAX_POINTS 10
+#endif
+
+// Pixels drawBitmapStream asks its source for at a time, 2 bytes of stack each
+#ifndef BITMAP_STREAM_CHUNK
+#define BITMAP_STREAM_CHUNK 32
+#endif
+
+/*
+  drawSprite data in program memory, transparency resolved into runs:
+    height                   1 byte
+    then for every row, runs of
+      skip                   1 byte, transparent pixels before the run
+      count                  1 byte, opaque pixels in the run, 0 ends the row
+      pixels                 count RGB565 values, high byte first
+  e.g. a 3x2 sprite with a transparent middle column:
+    2,  0,1,P,  1,1,P,  0,0,  0,3,P,P,P,  0,0
+  Rows are at most 255 pixels wide. tools/sprite565.py encodes a raw RGB565
+  image with one color taken as transparent into this format.
+*/
+
+// Display rotations, 0/90/180/270 degrees. The odd ones swap the axes.
 #define PORTRAIT 0
 #define LANDSCAPE 1
+#define PORTRAIT_FLIPPED 2
+#define LANDSCAPE_FLIPPED 3
 
 
 
@@ -111,66 +137,281 @@ struct _current_font
 	uint8_t numchars;
 };
 
-class UTFT
+/*
+  A sprite kept on screen by showSprite/moveSprite/hideSprite. image is a
+  drawBitmap style bitmap in flash, or 0 for a solid block in the current
+  color. What lies under the sprite is either kept in save (sx*sy words,
+  filled by GRAM readback, the sprite must then stay on screen) or, when
+  save is 0, repainted by background with the clip rectangle set to the
+  part being uncovered. x, y and visible are maintained by the library.
+*/
+struct UTFTSprite
+{
+	const bitmapdatatype image;
+	int sx, sy;
+	word *save;
+	void (*background)(int x1, int y1, int x2, int y2);
+	int x, y;
+	bool visible;
+};
+
+/*
+  UTFTBase holds the display state and everything that does not depend on
+  the orientation. The rotation itself is done by the controller (driver
+  output control RL/TB and entry mode, programmed once in InitLCD), so the
+  primitives only have to swap the axes for LANDSCAPE. They are member
+  templates instantiated for PORTRAIT and LANDSCAPE in UTFT.cpp, making the
+  swap a compile time decision. Use them through UTFTFixed (orientation fixed
+  at compile time) or UTFT (runtime orientation).
+
+  All primitives draw only inside the clip rectangle (setClipRect, display
+  coordinates, inclusive). InitLCD and clrClipRect reset it to the screen.
+  clrScr and fillScr fill the clip rectangle.
+*/
+class UTFTBase
 {
 	public:
-		UTFT();
+		UTFTBase();
+		
+		void setColor(byte r, byte g, byte b);
+		void setColor(word color);
+		word getColor();
+		void setBackColor(byte r, byte g, byte b);
+		void setBackColor(word color);
+		word getBackColor();
+		void setFont(const uint8_t* font);
+		const uint8_t* getFont();
+		uint8_t getFontXsize();
+		uint8_t getFontYsize();
+		void lcdOff();
+		void lcdOn();
+		void setContrast(char c);
+		word getDeviceID();
+		// true when the constructor found the panel still set up after a
+		// reset of the MCU alone and skipped init, the picture is intact
+		bool warmStart() { return warm; }
+		int setPixels( word color, uint16_t x, uint16_t y, uint32_t pixels );
+		void setScrollArea(int first, int last);
+		void scrollTo(int offset);
+		// first..last has to touch line 0 or the last line (the far end of
+		// the 320 lines), the controller can't keep a strip in the middle;
+		// one that doesn't is refused with false
+		bool setSplitScreen(int first, int last);
+		void clrSplitScreen();
+		int getScrollOffset() { return scroll_offset; }
+		int scrollLine(int line);
+		
+	protected:
+		static const word disp_x_size = 239;
+		static const word disp_y_size = 319;
+	
+		byte fch, fcl, bch, bcl;
+		_current_font	cfont;
+		int clip_x1, clip_y1, clip_x2, clip_y2;
+		int scroll_first, scroll_last, scroll_offset;
+		byte scroll_reg;
+		word device_id;
+		bool warm;
+		
+		void InitLCD(byte orientation);
+		void setPixel(word color);
+		void clrXY();
+		bool clipRect(int &x1, int &y1, int &x2, int &y2);
+		bool inClip(int x, int y) { return x>=clip_x1 && x<=clip_x2 && y>=clip_y1 && y<=clip_y2; }
+		
+		template <byte O> void clrScr();
+		template <byte O> void fillScr(byte r, byte g, byte b);
+		template <byte O> void fillScr(word color);
+		template <byte O> void setClipRect(int x1, int y1, int x2, int y2);
+		template <byte O> void clrClipRect();
+		template <byte O> void drawPixel(int x, int y);
+		template <byte O> void drawLine(int x1, int y1, int x2, int y2);
+		template <byte O> void drawLine(int x1, int y1, int x2, int y2, int width);
+		template <byte O> void drawPath(const int *xy, int points, bool closed, bool pgm);
+		template <byte O> void drawRect(int x1, int y1, int x2, int y2);
+		template <byte O> void drawRect(int x1, int y1, int x2, int y2, int width);
+		template <byte O> void drawRoundRect(int x1, int y1, int x2, int y2);
+		template <byte O> void fillRect(int x1, int y1, int x2, int y2);
+		template <byte O> void fillRoundRect(int x1, int y1, int x2, int y2);
+		template <byte O> void fillRectMasked(int x1, int y1, int x2, int y2, word mask);
+		template <byte O> void tintRect(int x1, int y1, int x2, int y2, word color);
+		template <byte O> void fillRectPattern(int x1, int y1, int x2, int y2, const uint8_t *pattern, byte size);
+		template <byte O> void fillRectGradient(int x1, int y1, int x2, int y2, const word *colors, byte stops, bool horizontal, bool dither);
+		template <byte O> void fillTriangle(int x1, int y1, int x2, int y2, int x3, int y3);
+		template <byte O> void fillPolygon(const int *xy, int points, bool nonzero, bool pgm);
+		template <byte O> void drawCircle(int x, int y, int radius);
+		template <byte O> void drawCircle(int x, int y, int radius, int width);
+		template <byte O> void fillCircle(int x, int y, int radius);
+		template <byte O> void ellipse(int x, int y, int rx, int ry, bool fill);
+		template <byte O> void fillArc(int x, int y, int r1, int r2, int start, int end);
+		template <byte O> void print(const char *st, int x, int y, int deg);
+		template <byte O> void printWithMargin(const char *st, int x, int y, int limit);
+		template <byte O> void printNumI(uint8_t num, int x, int y, int length, char filler);
+		template <byte O> void printNumF(double num, byte dec, int x, int y, char divider, int length, char filler);
+		template <byte O> void drawBitmap(int x, int y, int sx, int sy, const bitmapdatatype data, int scale);
+		template <byte O> void drawBitmapPB(int x, int y, int sx, int sy, const bitmapdatatype data);
+		template <byte O> void drawBitmapRAM(int x, int y, int sx, int sy, const word *data);
+		template <byte O> void drawBitmapRAM(int x, int y, int sx, int sy, const uint8_t *bits);
+		template <byte O> void drawBitmapStream(int x, int y, int sx, int sy, word (*source)(uint8_t *buf, word max));
+		template <byte O> void drawSprite(int x, int y, const uint8_t *sprite);
+		template <byte O> void readRect(int x1, int y1, int x2, int y2, word *buf);
+		template <byte O> word readPixel(int x, int y);
+		template <byte O> void writeRect(int x1, int y1, int x2, int y2, const word *buf);
+		template <byte O> void copyRect(int x1, int y1, int x2, int y2, int dx, int dy);
+		template <byte O> void showSprite(UTFTSprite &s, int x, int y);
+		template <byte O> void moveSprite(UTFTSprite &s, int x, int y);
+		template <byte O> void hideSprite(UTFTSprite &s);
+		template <byte O> void scroll(int lines, void (*repaint)(int first, int last));
+		template <byte O> void drawBitmap(int x, int y, int sx, int sy, const bitmapdatatype data, int deg, int rox, int roy);
+		template <byte O> int  getDisplayXSize();
+		template <byte O> int  getDisplayYSize();
 		
+		template <byte O> void plotPixel(int x, int y);
+		template <byte O> void lineSegment(int xa, int ya, int xb, int yb, bool skip, word &mode);
+		template <byte O> void drawHLine(int x, int y, int l);
+		template <byte O> void drawVLine(int x, int y, int l);
+		template <byte O> void fillSpan(int x1, int x2, int y);
+		template <byte O> void printChar(byte c, int x, int y);
+		template <byte O> void rotateChar(byte c, int x, int y, int pos, int deg);
+		template <byte O> void setXY(word x1, word y1, word x2, word y2);
+		template <byte O> void setXY(word x1, word y1, word x2, word y2, word mode);
+		template <byte O> void spriteStrip(UTFTSprite &s, int x1, int y1, int x2, int y2, bool save);
+		template <byte O> void repaintLines(int first, int last, void (*repaint)(int first, int last));
+};
+
+/*
+  Display with the orientation fixed at compile time. Only the code for the
+  chosen orientation is linked in, e.g. UTFTFixed<LANDSCAPE> display;
+  The flipped rotations share their code with the unflipped ones.
+*/
+template <byte orientation>
+class UTFTFixed : public UTFTBase
+{
+	public:
+		void InitLCD() { UTFTBase::InitLCD(orientation); }
+		
+		void clrScr() { UTFTBase::clrScr<orientation&LANDSCAPE>(); }
+		void fillScr(byte r, byte g, byte b) { UTFTBase::fillScr<orientation&LANDSCAPE>(r, g, b); }
+		void fillScr(word color) { UTFTBase::fillScr<orientation&LANDSCAPE>(color); }
+		void setClipRect(int x1, int y1, int x2, int y2) { UTFTBase::setClipRect<orientation&LANDSCAPE>(x1, y1, x2, y2); }
+		void clrClipRect() { UTFTBase::clrClipRect<orientation&LANDSCAPE>(); }
+		void drawPixel(int x, int y) { UTFTBase::drawPixel<orientation&LANDSCAPE>(x, y); }
+		void drawLine(int x1, int y1, int x2, int y2) { UTFTBase::drawLine<orientation&LANDSCAPE>(x1, y1, x2, y2); }
+		void drawLine(int x1, int y1, int x2, int y2, int width) { UTFTBase::drawLine<orientation&LANDSCAPE>(x1, y1, x2, y2, width); }
+		void drawPolyline(const int *xy, int points) { UTFTBase::drawPath<orientation&LANDSCAPE>(xy, points, false, false); }
+		void drawPolygon(const int *xy, int points) { UTFTBase::drawPath<orientation&LANDSCAPE>(xy, points, true, false); }
+		void drawPolylineP(const int *xy, int points) { UTFTBase::drawPath<orientation&LANDSCAPE>(xy, points, false, true); }
+		void drawPolygonP(const int *xy, int points) { UTFTBase::drawPath<orientation&LANDSCAPE>(xy, points, true, true); }
+		void drawRect(int x1, int y1, int x2, int y2) { UTFTBase::drawRect<orientation&LANDSCAPE>(x1, y1, x2, y2); }
+		void drawRect(int x1, int y1, int x2, int y2, int width) { UTFTBase::drawRect<orientation&LANDSCAPE>(x1, y1, x2, y2, width); }
+		void drawRoundRect(int x1, int y1, int x2, int y2) { UTFTBase::drawRoundRect<orientation&LANDSCAPE>(x1, y1, x2, y2); }
+		void fillRect(int x1, int y1, int x2, int y2) { UTFTBase::fillRect<orientation&LANDSCAPE>(x1, y1, x2, y2); }
+		void fillRoundRect(int x1, int y1, int x2, int y2) { UTFTBase::fillRoundRect<orientation&LANDSCAPE>(x1, y1, x2, y2); }
+		void fillRectMasked(int x1, int y1, int x2, int y2, word mask) { UTFTBase::fillRectMasked<orientation&LANDSCAPE>(x1, y1, x2, y2, mask); }
+		void tintRect(int x1, int y1, int x2, int y2, word color) { UTFTBase::tintRect<orientation&LANDSCAPE>(x1, y1, x2, y2, color); }
+		void fillRectPattern(int x1, int y1, int x2, int y2, const uint8_t *pattern, byte size=8) { UTFTBase::fillRectPattern<orientation&LANDSCAPE>(x1, y1, x2, y2, pattern, size); }
+		void fillRectGradient(int x1, int y1, int x2, int y2, word c1, word c2, bool horizontal=false, bool dither=false) { word colors[2] = { c1, c2 }; UTFTBase::fillRectGradient<orientation&LANDSCAPE>(x1, y1, x2, y2, colors, 2, horizontal, dither); }
+		void fillRectGradientStops(int x1, int y1, int x2, int y2, const word *colors, byte stops, bool horizontal=false, bool dither=false) { UTFTBase::fillRectGradient<orientation&LANDSCAPE>(x1, y1, x2, y2, colors, stops, horizontal, dither); }
+		void fillTriangle(int x1, int y1, int x2, int y2, int x3, int y3) { UTFTBase::fillTriangle<orientation&LANDSCAPE>(x1, y1, x2, y2, x3, y3); }
+		void fillPolygon(const int *xy, int points, bool nonzero=false) { UTFTBase::fillPolygon<orientation&LANDSCAPE>(xy, points, nonzero, false); }
+		void fillPolygonP(const int *xy, int points, bool nonzero=false) { UTFTBase::fillPolygon<orientation&LANDSCAPE>(xy, points, nonzero, true); }
+		void drawCircle(int x, int y, int radius) { UTFTBase::drawCircle<orientation&LANDSCAPE>(x, y, radius); }
+		void drawCircle(int x, int y, int radius, int width) { UTFTBase::drawCircle<orientation&LANDSCAPE>(x, y, radius, width); }
+		void fillCircle(int x, int y, int radius) { UTFTBase::fillCircle<orientation&LANDSCAPE>(x, y, radius); }
+		void drawEllipse(int x, int y, int rx, int ry) { UTFTBase::ellipse<orientation&LANDSCAPE>(x, y, rx, ry, false); }
+		void fillEllipse(int x, int y, int rx, int ry) { UTFTBase::ellipse<orientation&LANDSCAPE>(x, y, rx, ry, true); }
+		void drawArc(int x, int y, int radius, int start, int end) { UTFTBase::fillArc<orientation&LANDSCAPE>(x, y, radius-1, radius, start, end); }
+		void fillArc(int x, int y, int r1, int r2, int start, int end) { UTFTBase::fillArc<orientation&LANDSCAPE>(x, y, r1, r2, start, end); }
+		void print(const char *st, int x, int y, int deg=0) { UTFTBase::print<orientation&LANDSCAPE>(st, x, y, deg); }
+		void printWithMargin(const char *st, int x, int y, int limit=39) { UTFTBase::printWithMargin<orientation&LANDSCAPE>(st, x, y, limit); }
+		void printNumI(uint8_t num, int x, int y, int length=0, char filler=' ') { UTFTBase::printNumI<orientation&LANDSCAPE>(num, x, y, length, filler); }
+		void printNumF(double num, byte dec, int x, int y, char divider='.', int length=0, char filler=' ') { UTFTBase::printNumF<orientation&LANDSCAPE>(num, dec, x, y, divider, length, filler); }
+		void drawBitmap(int x, int y, int sx, int sy, const bitmapdatatype data, int scale=1) { UTFTBase::drawBitmap<orientation&LANDSCAPE>(x, y, sx, sy, data, scale); }
+		void drawBitmapPB(int x, int y, int sx, int sy, const bitmapdatatype data) { UTFTBase::drawBitmapPB<orientation&LANDSCAPE>(x, y, sx, sy, data); }
+		void drawBitmapRAM(int x, int y, int sx, int sy, const word *data) { UTFTBase::drawBitmapRAM<orientation&LANDSCAPE>(x, y, sx, sy, data); }
+		void drawBitmapRAM(int x, int y, int sx, int sy, const uint8_t *bits) { UTFTBase::drawBitmapRAM<orientation&LANDSCAPE>(x, y, sx, sy, bits); }
+		void drawBitmapStream(int x, int y, int sx, int sy, word (*source)(uint8_t *buf, word max)) { UTFTBase::drawBitmapStream<orientation&LANDSCAPE>(x, y, sx, sy, source); }
+		void drawSprite(int x, int y, const uint8_t *sprite) { UTFTBase::drawSprite<orientation&LANDSCAPE>(x, y, sprite); }
+		void readRect(int x1, int y1, int x2, int y2, word *buf) { UTFTBase::readRect<orientation&LANDSCAPE>(x1, y1, x2, y2, buf); }
+		word readPixel(int x, int y) { return UTFTBase::readPixel<orientation&LANDSCAPE>(x, y); }
+		void writeRect(int x1, int y1, int x2, int y2, const word *buf) { UTFTBase::writeRect<orientation&LANDSCAPE>(x1, y1, x2, y2, buf); }
+		void copyRect(int x1, int y1, int x2, int y2, int dx, int dy) { UTFTBase::copyRect<orientation&LANDSCAPE>(x1, y1, x2, y2, dx, dy); }
+		void showSprite(UTFTSprite &s, int x, int y) { UTFTBase::showSprite<orientation&LANDSCAPE>(s, x, y); }
+		void moveSprite(UTFTSprite &s, int x, int y) { UTFTBase::moveSprite<orientation&LANDSCAPE>(s, x, y); }
+		void hideSprite(UTFTSprite &s) { UTFTBase::hideSprite<orientation&LANDSCAPE>(s); }
+		void scroll(int lines, void (*repaint)(int first, int last)=0) { UTFTBase::scroll<orientation&LANDSCAPE>(lines, repaint); }
+		void drawBitmap(int x, int y, int sx, int sy, const bitmapdatatype data, int deg, int rox, int roy) { UTFTBase::drawBitmap<orientation&LANDSCAPE>(x, y, sx, sy, data, deg, rox, roy); }
+		int  getDisplayXSize() { return UTFTBase::getDisplayXSize<orientation&LANDSCAPE>(); }
+		int	 getDisplayYSize() { return UTFTBase::getDisplayYSize<orientation&LANDSCAPE>(); }
+};
+
+/*
+  Display with the orientation chosen at runtime by InitLCD(). Every call
+  dispatches to the PORTRAIT or LANDSCAPE instantiation, so both end up in
+  flash. Prefer UTFTFixed when the orientation is known up front.
+*/
+class UTFT : public UTFTBase
+{
+	public:
 		void InitLCD(byte orientation=LANDSCAPE);
 		
 		void clrScr();
-		void drawPixel(int x, int y);
-		void drawLine(int x1, int y1, int x2, int y2);
-
 		void fillScr(byte r, byte g, byte b);
 		void fillScr(word color);
+		void setClipRect(int x1, int y1, int x2, int y2);
+		void clrClipRect();
+		void drawPixel(int x, int y);
+		void drawLine(int x1, int y1, int x2, int y2);
+		void drawLine(int x1, int y1, int x2, int y2, int width);
+		void drawPolyline(const int *xy, int points);
+		void drawPolygon(const int *xy, int points);
+		void drawPolylineP(const int *xy, int points);
+		void drawPolygonP(const int *xy, int points);
 		void drawRect(int x1, int y1, int x2, int y2);
+		void drawRect(int x1, int y1, int x2, int y2, int width);
 		void drawRoundRect(int x1, int y1, int x2, int y2);
 		void fillRect(int x1, int y1, int x2, int y2);
 		void fillRoundRect(int x1, int y1, int x2, int y2);
+		void fillRectMasked(int x1, int y1, int x2, int y2, word mask);
+		void tintRect(int x1, int y1, int x2, int y2, word color);
+		void fillRectPattern(int x1, int y1, int x2, int y2, const uint8_t *pattern, byte size=8);
+		void fillRectGradient(int x1, int y1, int x2, int y2, word c1, word c2, bool horizontal=false, bool dither=false);
+		void fillRectGradientStops(int x1, int y1, int x2, int y2, const word *colors, byte stops, bool horizontal=false, bool dither=false);
+		void fillTriangle(int x1, int y1, int x2, int y2, int x3, int y3);
+		void fillPolygon(const int *xy, int points, bool nonzero=false);
+		void fillPolygonP(const int *xy, int points, bool nonzero=false);
 		void drawCircle(int x, int y, int radius);
+		void drawCircle(int x, int y, int radius, int width);
 		void fillCircle(int x, int y, int radius);
-		void setColor(byte r, byte g, byte b);
-		void setColor(word color);
-		word getColor();
-		void setBackColor(byte r, byte g, byte b);
-		void setBackColor(word color);
-		word getBackColor();
+		void drawEllipse(int x, int y, int rx, int ry);
+		void fillEllipse(int x, int y, int rx, int ry);
+		void drawArc(int x, int y, int radius, int start, int end);
+		void fillArc(int x, int y, int r1, int r2, int start, int end);
 		void print(const char *st, int x, int y, int deg=0);
 		void printWithMargin(const char *st, int x, int y, int limit=39);
 		//void print(String st, int x, int y, int deg=0);
 		void printNumI(uint8_t num, int x, int y, int length=0, char filler=' ');
 		void printNumF(double num, byte dec, int x, int y, char divider='.', int length=0, char filler=' ');
-		void setFont(const uint8_t* font);
-		const uint8_t* getFont();
-		uint8_t getFontXsize();
-		uint8_t getFontYsize();
 		void drawBitmap(int x, int y, int sx, int sy, const bitmapdatatype data, int scale=1);
 		void drawBitmapPB(int x, int y, int sx, int sy, const bitmapdatatype data);
+		void drawBitmapRAM(int x, int y, int sx, int sy, const word *data);
+		void drawBitmapRAM(int x, int y, int sx, int sy, const uint8_t *bits);
+		void drawBitmapStream(int x, int y, int sx, int sy, word (*source)(uint8_t *buf, word max));
+		void drawSprite(int x, int y, const uint8_t *sprite);
+		void readRect(int x1, int y1, int x2, int y2, word *buf);
+		word readPixel(int x, int y);
+		void writeRect(int x1, int y1, int x2, int y2, const word *buf);
+		void copyRect(int x1, int y1, int x2, int y2, int dx, int dy);
+		void showSprite(UTFTSprite &s, int x, int y);
+		void moveSprite(UTFTSprite &s, int x, int y);
+		void hideSprite(UTFTSprite &s);
+		void scroll(int lines, void (*repaint)(int first, int last)=0);
 		void drawBitmap(int x, int y, int sx, int sy, const bitmapdatatype data, int deg, int rox, int roy);
-		void lcdOff();
-		void lcdOn();
-		void setContrast(char c);
 		int  getDisplayXSize();
 		int	 getDisplayYSize();
-		int setPixels( word color, uint16_t x, uint16_t y, uint32_t pixels );
 		
 	protected:
-		byte fch, fcl, bch, bcl;
 		byte orient;
-		long disp_x_size, disp_y_size;
-		_current_font	cfont;
-		
-		void _hw_special_init();
-		void setPixel(word color);
-		void drawHLine(int x, int y, int l);
-		void drawVLine(int x, int y, int l);
-		void printChar(byte c, int x, int y);
-		void printChar2(byte c, int x, int y);
-		void rotateChar(byte c, int x, int y, int pos, int deg);
-		void setXY(word x1, word y1, word x2, word y2);
-		void clrXY();
-
 };
 
 #endif
\ No newline at end of file
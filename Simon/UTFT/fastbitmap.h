@@ -21,4 +21,16 @@
 void fastbitmap_1bit(uint16_t length, const uint16_t address, uint16_t fgcolor, uint16_t bg_color  ) asm ("fastbitmap_1bit");
 
 void fastbitmap_16bit(uint16_t length, const uint16_t address ) asm ("fastbitmap_16bit");
+
+// the same reading SRAM, 16 bit pixels are native words there
+void fastbitmap_1bit_ram(uint16_t length, const void *address, uint16_t fgcolor, uint16_t bg_color ) asm ("fastbitmap_1bit_ram");
+void fastbitmap_16bit_ram(uint16_t length, const uint16_t *address ) asm ("fastbitmap_16bit_ram");
+
+// clipped variants, draw a width x height window out of a larger bitmap
+void fastbitmap_1bit_rect(const uint16_t address, uint16_t width, uint16_t height, uint8_t skipbits, uint8_t stride, uint16_t fgcolor, uint16_t bg_color ) asm ("fastbitmap_1bit_rect");
+void fastbitmap_1bit_rect_ram(const void *address, uint16_t width, uint16_t height, uint8_t skipbits, uint8_t stride, uint16_t fgcolor, uint16_t bg_color ) asm ("fastbitmap_1bit_rect_ram");
+void fastbitmap_16bit_rect(const uint16_t address, uint16_t width, uint16_t height, uint16_t skipbytes ) asm ("fastbitmap_16bit_rect");
 void fastbitmap_pb565( const uint16_t address) asm("fastbitmap_pb565");
+
+// tiles an 8x8 (wide = 0) or 16x16 (wide = 1) 1 bit pattern, phase is x offset | y offset << 4
+void fastpattern(uint16_t width, uint16_t height, const uint16_t address, uint8_t phase, uint8_t wide, uint16_t fgcolor, uint16_t bg_color ) asm ("fastpattern");
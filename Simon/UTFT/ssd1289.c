@@ -18,14 +18,73 @@
  */ 
 
 #include "config.h"
+#include <avr/pgmspace.h>
 #include <util/delay.h>
 #include "ssd1289.h"
 #include "fastio.h"
 
 
+// Register settings after reset, gamma included
+const SSD1289_init_step SSD1289_init_table[] PROGMEM =
+{
+	{ 0x00, 0x0001, 10 },		// oscillator on, stable after 10 ms per the datasheet
+	{ 0x03, 0xA8A4, 0 },
+	{ 0x0C, 0x0000, 0 },
+	{ 0x0D, 0x080C, 0 },
+	{ 0x0E, 0x2B00, 0 },
+	{ 0x1E, 0x00B7, 0 },
+	{ 0x01, 0x2B3F, 0 },
+	{ 0x02, 0x0600, 0 },
+	{ 0x10, 0x0000, 30 },		// sleep off, 30 ms before display on per the datasheet
+	{ 0x11, 0x6070, 0 },
+	{ 0x05, 0x0000, 0 },
+	{ 0x06, 0x0000, 0 },
+	{ 0x16, 0xEF1C, 0 },
+	{ 0x17, 0x0003, 0 },
+	{ 0x07, SSD1289_R07, 0 },
+	{ 0x0B, 0x0000, 0 },
+	{ 0x0F, 0x0000, 0 },
+	{ 0x41, 0x0000, 0 },
+	{ 0x42, 0x0000, 0 },
+	{ 0x48, 0x0000, 0 },
+	{ 0x49, 0x013F, 0 },
+	{ 0x4A, 0x0000, 0 },
+	{ 0x4B, 0x0000, 0 },
+	{ 0x44, 0xEF00, 0 },
+	{ 0x45, 0x0000, 0 },
+	{ 0x46, 0x013F, 0 },
+	{ 0x30, 0x0707, 0 },
+	{ 0x31, 0x0204, 0 },
+	{ 0x32, 0x0204, 0 },
+	{ 0x33, 0x0502, 0 },
+	{ 0x34, 0x0507, 0 },
+	{ 0x35, 0x0204, 0 },
+	{ 0x36, 0x0204, 0 },
+	{ 0x37, 0x0502, 0 },
+	{ 0x3A, 0x0302, 0 },
+	{ 0x3B, 0x0302, 0 },
+	{ 0x23, 0x0000, 0 },
+	{ 0x24, 0x0000, 0 },
+	{ 0x25, 0x8000, 0 },
+	{ 0x4f, 0x0000, 0 },
+	{ 0x4e, 0x0000, 0 },
+	{ SSD1289_INIT_END, 0, 0 }
+};
 
-void SSD1289_init()
-{	
+
+uint16_t SSD1289_init()
+{
+	return SSD1289_init_with(SSD1289_init_table);
+}
+
+static void SSD1289_pins()
+{
+	// idle levels before the pins become outputs, a glitch on RESET
+	// would wipe a panel that is still set up
+	sbi(RESET_PORT, RESET_PIN);
+	sbi(WR_PORT, WR_PIN);
+	sbi(CS_PORT, CS_PIN);
+	
 	DATA_PORT_LOW_DDR = 0xff;
 	DATA_PORT_HIGH_DDR = 0xff;
 			
@@ -43,60 +102,83 @@ void SSD1289_init()
 	BACK_LIGHT_PORT |= _BV(BACK_LIGHT_PIN);
 	
 	BACK_LIGHT_DDR |= _BV(BACK_LIGHT_PIN);			
+}
+
+uint16_t SSD1289_init_with(const SSD1289_init_step *table)
+{	
+	SSD1289_pins();
 	
-	sbi(RESET_PORT, RESET_PIN);
-	_delay_ms(5);
 	cbi(RESET_PORT, RESET_PIN);
-	_delay_ms(15);
+	_delay_us(SSD1289_RESET_PULSE_US);
 	sbi(RESET_PORT, RESET_PIN);
-	_delay_ms(15);
+	_delay_ms(SSD1289_RESET_WAIT_MS);
 
 	cbi(CS_PORT, CS_PIN);
 
-	LCD_Write_COM_DATA(0x00,0x0001);
-	LCD_Write_COM_DATA(0x03,0xA8A4);
-	LCD_Write_COM_DATA(0x0C,0x0000);
-	LCD_Write_COM_DATA(0x0D,0x080C);
-	LCD_Write_COM_DATA(0x0E,0x2B00);
-	LCD_Write_COM_DATA(0x1E,0x00B7);
-	LCD_Write_COM_DATA(0x01,0x2B3F);
-	LCD_Write_COM_DATA(0x02,0x0600);
-	LCD_Write_COM_DATA(0x10,0x0000);
-	LCD_Write_COM_DATA(0x11,0x6070);
-	LCD_Write_COM_DATA(0x05,0x0000);
-	LCD_Write_COM_DATA(0x06,0x0000);
-	LCD_Write_COM_DATA(0x16,0xEF1C);
-	LCD_Write_COM_DATA(0x17,0x0003);
-	LCD_Write_COM_DATA(0x07,0x0233);
-	LCD_Write_COM_DATA(0x0B,0x0000);
-	LCD_Write_COM_DATA(0x0F,0x0000);
-	LCD_Write_COM_DATA(0x41,0x0000);
-	LCD_Write_COM_DATA(0x42,0x0000);
-	LCD_Write_COM_DATA(0x48,0x0000);
-	LCD_Write_COM_DATA(0x49,0x013F);
-	LCD_Write_COM_DATA(0x4A,0x0000);
-	LCD_Write_COM_DATA(0x4B,0x0000);
-	LCD_Write_COM_DATA(0x44,0xEF00);
-	LCD_Write_COM_DATA(0x45,0x0000);
-	LCD_Write_COM_DATA(0x46,0x013F);
-	LCD_Write_COM_DATA(0x30,0x0707);
-	LCD_Write_COM_DATA(0x31,0x0204);
-	LCD_Write_COM_DATA(0x32,0x0204);
-	LCD_Write_COM_DATA(0x33,0x0502);
-	LCD_Write_COM_DATA(0x34,0x0507);
-	LCD_Write_COM_DATA(0x35,0x0204);
-	LCD_Write_COM_DATA(0x36,0x0204);
-	LCD_Write_COM_DATA(0x37,0x0502);
-	LCD_Write_COM_DATA(0x3A,0x0302);
-	LCD_Write_COM_DATA(0x3B,0x0302);
-	LCD_Write_COM_DATA(0x23,0x0000);
-	LCD_Write_COM_DATA(0x24,0x0000);
-	LCD_Write_COM_DATA(0x25,0x8000);
-	LCD_Write_COM_DATA(0x4f,0x0000);
-	LCD_Write_COM_DATA(0x4e,0x0000);
+	for (;;)
+	{
+		uint8_t reg = pgm_read_byte(&table->reg);
+		uint8_t wait = pgm_read_byte(&table->delay);
+		
+		if (reg==SSD1289_INIT_END)
+			break;
+		LCD_Write_COM_DATA(reg, pgm_read_word(&table->value));
+		while (wait--)
+			_delay_ms(1);
+		table++;
+	}
 	LCD_Write_COM(0x22);
 
+	sbi(CS_PORT, CS_PIN);
+	
+	return SSD1289_readReg(0x00);
+}
 
+/*
+  Reads a register back over the data bus. Register 0x00 holds the device
+  code, 0x8989 for an SSD1289.
+*/
+uint16_t SSD1289_readReg(uint8_t reg)
+{
+	uint16_t v;
+	
+	cbi(CS_PORT, CS_PIN);
+	LCD_Write_COM(reg);
+	sbi(RS_PORT, RS_PIN);
+	
+	DATA_PORT_LOW_DDR = 0;
+	DATA_PORT_HIGH_DDR = 0;
+	DATA_PORT_LOW = 0;
+	DATA_PORT_HIGH = 0;
+	
+	cbi(RD_PORT, RD_PIN);
+	_delay_us(1);
+	v = (DATA_PORT_HIGH_PIN << 8) | DATA_PORT_LOW_PIN;
+	sbi(RD_PORT, RD_PIN);
+	
+	DATA_PORT_LOW_DDR = 0xff;
+	DATA_PORT_HIGH_DDR = 0xff;
 	sbi(CS_PORT, CS_PIN);
 	
+	return v;
+}
+
+/*
+  Sets up the pins without resetting the panel and tells whether it is
+  still configured. Only a reset of the MCU alone, through its RESET pin,
+  can leave the panel set up; after power on or a brown-out it needs init.
+  Register 00 answers 0x8989 either way, so it only shows a panel is there;
+  register 07 is 0 out of the panel's reset and has the display on bits
+  once init ran. The split screen bits in it may be either way.
+  The reset flags in MCUCSR are left for the application to clear.
+*/
+uint8_t SSD1289_ready()
+{
+	SSD1289_pins();
+	
+	if (!(MCUCSR & _BV(EXTRF)) || (MCUCSR & (_BV(PORF) | _BV(BORF))))
+		return 0;
+	if (SSD1289_readReg(0x00)!=SSD1289_ID)
+		return 0;
+	return (SSD1289_readReg(0x07) & ~(VLE1|VLE2|SPT))==(SSD1289_R07 & ~(VLE1|VLE2|SPT));
 }
@@ -21,6 +21,8 @@
 #define DATA_PORT_HIGH PORTD
 #define DATA_PORT_LOW_DDR DDRA
 #define DATA_PORT_HIGH_DDR DDRD
+#define DATA_PORT_LOW_PIN PINA
+#define DATA_PORT_HIGH_PIN PIND
 
 #define RS_PORT PORTC
 #define RS_PIN 6
@@ -45,6 +47,17 @@
 //#define F_CPU 12000000
 #define F_CPU 7372800UL
 
+/* 1 inlines the bus writes of fastio.h, 0 calls the fastio.S versions.
+   Inlining grows every call site, define it 0 if the flash runs out */
+#ifndef FASTIO_INLINE
+#define FASTIO_INLINE 1
+#endif
+
+/* Pixels per pass of the unrolled fastfill loop, 32 or 64 */
+#ifndef FASTFILL_UNROLL
+#define FASTFILL_UNROLL 32
+#endif
+
 #define HAVE_STATUS_LED 0	
 #define STATUS_LED_PORT PORTB
 #define STATUS_LED_PIN PORTB0
@@ -21,7 +21,15 @@
 #define FASTFILL_H_
 
 #include <stdint.h>
+// any 32 bit number of pixels, FASTFILL_UNROLL (config.h) per loop pass
 void fastfill(uint32_t pix) asm ("fastfill");
+// the same entry, kept for old callers
 void fastfill3(uint32_t pix) asm ("fastfill3");
 
+// lines of length pixels, r/g/b in 8.8 fixed point stepped by dr/dg/db per line
+void fastgradient(uint16_t length, uint16_t lines, uint16_t r, uint16_t g, uint16_t b, uint16_t dr, uint16_t dg, uint16_t db) asm ("fastgradient");
+// the same with 4x4 Bayer dithering, phase is the first pixel's position in its line & 3 |
+// (the first line's & 3) << 2, | 0x10 when the lines are columns so the matrix stays on screen x, y
+void fastgradient_dither(uint16_t length, uint16_t lines, uint16_t r, uint16_t g, uint16_t b, uint16_t dr, uint16_t dg, uint16_t db, uint8_t phase) asm ("fastgradient_dither");
+
 #endif /* FASTFILL_H_ */
\ No newline at end of file
@@ -23,11 +23,72 @@
 #define FASTIO_H_
 
 #include <stdint.h>
+#include "config.h"
+
+#if FASTIO_INLINE
+
+/*
+  Inline versions of the bus writes in fastio.S, which stay for assembly
+  callers. Constant registers and values become immediates and the
+  call/ret around every register write of a window setup goes away.
+*/
+#define FASTIO_STROBE()\
+	WR_PORT &= ~_BV(WR_PIN);\
+	WR_PORT |= _BV(WR_PIN);
+
+static inline void LCD_Writ_Bus(char VH,char VL, uint8_t mode) __attribute__((always_inline));
+static inline void LCD_Writ_Bus(char VH,char VL, uint8_t mode)
+{
+	DATA_PORT_HIGH = VH;
+	DATA_PORT_LOW = VL;
+	FASTIO_STROBE();
+}
+
+static inline void LCD_Write_COM(uint8_t vl) __attribute__((always_inline));
+static inline void LCD_Write_COM(uint8_t vl)
+{
+	RS_PORT &= ~_BV(RS_PIN);
+	DATA_PORT_LOW = vl;
+	DATA_PORT_HIGH = 0;
+	FASTIO_STROBE();
+}
+
+static inline void LCD_Write_DATA(uint8_t vh, uint8_t vl) __attribute__((always_inline));
+static inline void LCD_Write_DATA(uint8_t vh, uint8_t vl)
+{
+	RS_PORT |= _BV(RS_PIN);
+	DATA_PORT_LOW = vl;
+	DATA_PORT_HIGH = vh;
+	FASTIO_STROBE();
+}
+
+static inline void LCD_Write_COM_DATA(uint8_t com, uint16_t v) __attribute__((always_inline));
+static inline void LCD_Write_COM_DATA(uint8_t com, uint16_t v)
+{
+	LCD_Write_COM(com);
+	LCD_Write_DATA(v >> 8, v & 0xFF);
+}
+
+#else
 
 void LCD_Writ_Bus(char VH,char VL, uint8_t mode) asm("LCD_Writ_Bus");
 void LCD_Write_COM(uint8_t vl) asm("LCD_Write_COM");
 void LCD_Write_DATA(uint8_t vh, uint8_t vl) asm("LCD_Write_DATA");
 void LCD_Write_COM_DATA(uint8_t com, uint16_t v) asm("LCD_Write_COM_DATA");
 
+#endif
+
+void LCD_Read_GRAM(uint16_t count, uint16_t *buffer) asm("LCD_Read_GRAM");
+
+// Register values for LCD_Prepare_GRAM, in the order they are written
+typedef struct
+{
+	uint16_t r11;			// entry mode
+	uint16_t r44, r45, r46;	// window
+	uint16_t r4e, r4f;		// cursor
+} LCD_Window;
+
+void LCD_Prepare_GRAM(const LCD_Window *window) asm("LCD_Prepare_GRAM");
+
 
 #endif /* FASTIO_H_ */
\ No newline at end of file
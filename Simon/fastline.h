@@ -21,16 +21,20 @@
 #ifndef FASTLINE_H_
 #define FASTLINE_H_
 
-
+/*
+ Run-slice line kernels, A walks y and B walks x. The line is count pixels
+ from (major, minor); the first run is run pixels long, after that runs are
+ q or q+1 long depending on the error term num, see fastline.S.
+*/
  
- void fastlineANN(uint16_t color, uint16_t xa, uint16_t xb, uint16_t ya, uint16_t yb, uint16_t dx, uint16_t dy) asm ("fastlineANN");
- void fastlineANP(uint16_t color, uint16_t xa, uint16_t xb, uint16_t ya, uint16_t yb, uint16_t dx, uint16_t dy) asm ("fastlineANP");
- void fastlineAPN(uint16_t color, uint16_t xa, uint16_t xb, uint16_t ya, uint16_t yb, uint16_t dx, uint16_t dy) asm ("fastlineAPN");
- void fastlineAPP(uint16_t color, uint16_t xa, uint16_t xb, uint16_t ya, uint16_t yb, uint16_t dx, uint16_t dy) asm ("fastlineAPP");
- void fastlineBNN(uint16_t color, uint16_t xa, uint16_t xb, uint16_t ya, uint16_t yb, uint16_t dx, uint16_t dy) asm ("fastlineBNN");
- void fastlineBNP(uint16_t color, uint16_t xa, uint16_t xb, uint16_t ya, uint16_t yb, uint16_t dx, uint16_t dy) asm ("fastlineBNP");
- void fastlineBPN(uint16_t color, uint16_t xa, uint16_t xb, uint16_t ya, uint16_t yb, uint16_t dx, uint16_t dy) asm ("fastlineBPN");
- void fastlineBPP(uint16_t color, uint16_t xa, uint16_t xb, uint16_t ya, uint16_t yb, uint16_t dx, uint16_t dy) asm ("fastlineBPP");
+ void fastlineANN(uint16_t color, uint16_t major, uint16_t minor, uint16_t count, uint16_t run, uint16_t q, uint16_t r, uint16_t dmin, uint16_t num) asm ("fastlineANN");
+ void fastlineANP(uint16_t color, uint16_t major, uint16_t minor, uint16_t count, uint16_t run, uint16_t q, uint16_t r, uint16_t dmin, uint16_t num) asm ("fastlineANP");
+ void fastlineAPN(uint16_t color, uint16_t major, uint16_t minor, uint16_t count, uint16_t run, uint16_t q, uint16_t r, uint16_t dmin, uint16_t num) asm ("fastlineAPN");
+ void fastlineAPP(uint16_t color, uint16_t major, uint16_t minor, uint16_t count, uint16_t run, uint16_t q, uint16_t r, uint16_t dmin, uint16_t num) asm ("fastlineAPP");
+ void fastlineBNN(uint16_t color, uint16_t major, uint16_t minor, uint16_t count, uint16_t run, uint16_t q, uint16_t r, uint16_t dmin, uint16_t num) asm ("fastlineBNN");
+ void fastlineBNP(uint16_t color, uint16_t major, uint16_t minor, uint16_t count, uint16_t run, uint16_t q, uint16_t r, uint16_t dmin, uint16_t num) asm ("fastlineBNP");
+ void fastlineBPN(uint16_t color, uint16_t major, uint16_t minor, uint16_t count, uint16_t run, uint16_t q, uint16_t r, uint16_t dmin, uint16_t num) asm ("fastlineBPN");
+ void fastlineBPP(uint16_t color, uint16_t major, uint16_t minor, uint16_t count, uint16_t run, uint16_t q, uint16_t r, uint16_t dmin, uint16_t num) asm ("fastlineBPP");
 
 
 
@@ -27,9 +27,10 @@
 /*
 * UTFT is a library that allows user to display images and text on various TFT (Thin-Film Transistor) displays
 * UTFT display object will be used to draw components of the game on TFT LCD
+* The game always runs in landscape so the orientation is fixed at compile time
 */
 
-UTFT display; //Display class
+UTFTFixed<LANDSCAPE> display; //Display class
 
 
 /**
@@ -284,24 +285,131 @@ int countAnswer = 0;
  */
 int totalCorrectAnswers = 1;
 
-int main(void)
-{
-	
-	// Button ports
-	PORTB = 0xff;
-	DDRB = 0x00;
-	
-	// LCD init
-	display.clrScr();
-	display.InitLCD(LANDSCAPE);
+/**
+ * Keys 1-4 held down together start a new game without a reset.
+ */
+#define KEYS_DOWN (~PINB & 0x0F)
+#define KEY_CHORD 0x0F
+#define KEY_CHORD_PRESSED (KEYS_DOWN == KEY_CHORD)
 
-	
+/**
+ * The time in ms the pressed keys have to stay the same before they are taken as an answer.
+ */
+#define KEY_SETTLE_MS 20
+
+/**
+ * The band the CORRECT message is printed in, across all four rectangles.
+ */
+#define MESSAGE_REGION 0, 110, 319, 125
+
+/**
+ * The newGame function resets the game state and fills simonArray with a new color sequence.
+ */
+void newGame()
+{
 	// Fill simonArray with random numbers from 1-4
 	for(int i = 0; i < 30; i++){
 		int randomValue = rand() % 4 + 1;
 		simonArray[i] = Simon(randomValue);
 		correctAnswer[i] = randomValue;
 	}
+	
+	turnCPU = 1;
+	turnPlayer = 0;
+	numberOfSimons = 1;
+	error = 0;
+	countAnswer = 0;
+	totalCorrectAnswers = 1;
+}
+
+/**
+ * The restoreBoard function repaints only the parts of the screen that no longer show the board.
+ * Each rectangle is checked at a pixel only its fill color covers and, if that pixel is off,
+ * redrawn with the clip rectangle set to it. The message band is always redrawn.
+ */
+void restoreBoard()
+{
+	static const int rects[4][6] = {
+		{ 0, 0, 150, 120, 10, 10 },
+		{ 0, 120, 150, 239, 10, 230 },
+		{ 150, 0, 319, 120, 310, 10 },
+		{ 150, 120, 319, 239, 310, 230 }
+	};
+	static const byte colors[4][3] = { { RED }, { GREEN }, { BLUE }, { YELLOW } };
+	
+	for(int i = 0; i < 4; i++){
+		display.setColor(colors[i][0], colors[i][1], colors[i][2]);
+		if(display.readPixel(rects[i][4], rects[i][5]) != display.getColor()){
+			display.setClipRect(rects[i][0], rects[i][1], rects[i][2], rects[i][3]);
+			drawLine();
+			display.clrClipRect();
+		}
+	}
+	
+	display.setClipRect(MESSAGE_REGION);
+	drawLine();
+	display.clrClipRect();
+}
+
+/**
+ * The readKeys function returns the keys down (bit 0 is key1) once they have stayed the same for
+ * KEY_SETTLE_MS, or KEY_CHORD as soon as all four are down together, so the chord is never taken as an answer.
+ * A key let go before it settled still counts.
+ */
+uint8_t readKeys()
+{
+	uint8_t keys = KEYS_DOWN;
+	uint8_t stable = 0;
+	
+	while(keys != 0 && keys != KEY_CHORD && stable < KEY_SETTLE_MS){
+		_delay_ms(1);
+		uint8_t now = KEYS_DOWN;
+		if(now == keys){
+			stable++;
+		}
+		else if(now == 0){
+			break;
+		}
+		else{
+			keys = now;
+			stable = 0;
+		}
+	}
+	return keys;
+}
+
+/**
+ * The restartGame function waits for the keys to be released and starts a new game on the board as it is.
+ * No debounce is needed, the CPU's first sequence plays before the keys are read again.
+ */
+void restartGame()
+{
+	while((PINB & 0x0F) != 0x0F);
+	
+	newGame();
+	restoreBoard();
+}
+
+int main(void)
+{
+	// A press of RESET restarts only the MCU, the display found the LCD still set up and its picture kept
+	uint8_t warmStart = display.warmStart();
+	MCUCSR = 0;
+	
+	// Button ports, PB5 is the LCD's RD line and stays an output
+	PORTB = 0xff;
+	DDRB &= ~0x0F;
+	
+	// LCD init
+	display.InitLCD();
+	if(warmStart){
+		restoreBoard();
+	}
+	else{
+		display.clrScr();
+	}
+	
+	newGame();
 
 	// The while loop is the main game loop that updates and renders the game elements
 	while (1)
@@ -312,7 +420,8 @@ int main(void)
 			display.setColor(RED);
 			display.setFont(BigFont);
 			display.print("GAME OVER", CENTER, 110);
-			while(1);
+			while(!KEY_CHORD_PRESSED);
+			restartGame();
 		}
 		
 		// If player has answered correctly go to the next iteration
@@ -324,7 +433,9 @@ int main(void)
 				display.setColor(WHITE);
 				display.setFont(BigFont);
 				display.print("YOU WIN", CENTER, 110);
-				while(1);
+				while(!KEY_CHORD_PRESSED);
+				restartGame();
+				continue;
 			}
 			
 			// CPUs turn to blink next color sequence
@@ -340,8 +451,15 @@ int main(void)
 			// Draw default screen while you wait for players input
 			drawLine();
 			
+			// All four keys together start over, before any of them counts as an answer
+			uint8_t keys = readKeys();
+			if(keys == KEY_CHORD){
+				restartGame();
+				continue;
+			}
+			
 			// Check if pressed key1 is correct answer in the color sequence
-			if((PINB & (1 << PB0)) == 0){
+			if(keys & (1 << PB0)){
 				int x = 1;
 				if(correctAnswer[countAnswer] == x){
 					countAnswer++;
@@ -356,7 +474,7 @@ int main(void)
 			}
 			
 			// Check if pressed key2 is correct answer in the color sequence
-			if((PINB & (1 << PB1)) == 0){
+			if(keys & (1 << PB1)){
 				int x = 2;
 				if(correctAnswer[countAnswer] == x){
 					countAnswer++;
@@ -372,7 +490,7 @@ int main(void)
 			}
 			
 			// Check if pressed key3 is correct answer in the color sequence
-			if((PINB & (1 << PB2)) == 0){
+			if(keys & (1 << PB2)){
 				int x = 3;
 				if(correctAnswer[countAnswer] == x){
 					countAnswer++;
@@ -388,7 +506,7 @@ int main(void)
 			}
 			
 			// Check if pressed key4 is correct answer in the color sequence
-			if((PINB & (1 << PB3)) == 0){
+			if(keys & (1 << PB3)){
 				int x = 4;
 				if(correctAnswer[countAnswer] == x){
 					countAnswer++;
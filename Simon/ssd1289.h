@@ -30,7 +30,38 @@ extern "C" {
 #include "fastbitmap.h"
 #include "fastfill.h"
 
-void SSD1289_init();
+/*
+  One step of a panel init table in program memory: register, value and
+  milliseconds to wait after writing it. SSD1289_INIT_END ends the table.
+*/
+typedef struct
+{
+	uint8_t reg;
+	uint16_t value;
+	uint8_t delay;
+} SSD1289_init_step;
+
+#define SSD1289_INIT_END 0xff
+
+// Device code in register 0x00
+#define SSD1289_ID 0x8989
+
+// Reset timing, the low pulse and the wait before the first command, the
+// datasheet minimums of 10 us low and 1 ms before the first access
+#ifndef SSD1289_RESET_PULSE_US
+#define SSD1289_RESET_PULSE_US 10
+#endif
+#ifndef SSD1289_RESET_WAIT_MS
+#define SSD1289_RESET_WAIT_MS 1
+#endif
+
+extern const SSD1289_init_step SSD1289_init_table[];
+
+// Both return the device code read back after init, SSD1289_ID if all went well
+uint16_t SSD1289_init();
+uint16_t SSD1289_init_with(const SSD1289_init_step *table);
+uint16_t SSD1289_readReg(uint8_t reg);
+uint8_t SSD1289_ready();
 
 #define sbi( port, pin ) ( port |= _BV(pin) )
 #define cbi( port, pin ) ( port &= ~_BV(pin) )
@@ -44,12 +75,18 @@ void SSD1289_init();
 	DATA_PORT_LOW = 0xff;\
 	DATA_PORT_HIGH = 0xff;\
 
-#define SSD1289_setXY( x1, y1, x2, y2, x, y )\
+#define SSD1289_setWindow( x1, y1, x2, y2 )\
 	LCD_Write_COM_DATA(0x44,((x2)<<8)+x1);\
 	LCD_Write_COM_DATA(0x45,y1);\
-	LCD_Write_COM_DATA(0x46,y2);\
+	LCD_Write_COM_DATA(0x46,y2);
+
+#define SSD1289_setCursor( x, y )\
 	LCD_Write_COM_DATA(0x4e,x);\
 	LCD_Write_COM_DATA(0x4f,y);
+
+#define SSD1289_setXY( x1, y1, x2, y2, x, y )\
+	SSD1289_setWindow(x1, y1, x2, y2);\
+	SSD1289_setCursor(x, y);
 	
 #define SSD1289_dataFollows()\
 	LCD_Write_COM(0x22);\
@@ -63,6 +100,33 @@ void SSD1289_init();
 
 #define SSD1289_reg11( v )\
 	LCD_Write_COM_DATA(0x11, v);	
+
+// Register 01 (driver output control) bits
+#define RL 0x4000
+#define TB 0x0200
+
+// Register 01 without RL/TB: reverse, BGR and 320 gate lines
+#define SSD1289_R01 0x293F
+
+#define SSD1289_reg01( v )\
+	LCD_Write_COM_DATA(0x01, v);
+
+// Register 07 (display control) bits
+#define VLE2 0x0400
+#define VLE1 0x0200
+#define SPT 0x0100
+
+// Register 07 as set by SSD1289_init: display on, first screen scrolls
+#define SSD1289_R07 0x0233
+
+#define SSD1289_reg07( v )\
+	LCD_Write_COM_DATA(0x07, v);
+
+// Registers 23/24 (RAM write data mask): 6 bit red and green in 23, blue
+// in 24, a set bit leaves that bit of GRAM unchanged
+#define SSD1289_writeMask( rg, b )\
+	LCD_Write_COM_DATA(0x23, rg);\
+	LCD_Write_COM_DATA(0x24, b);
 	
 #ifdef __cplusplus
 }
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""
+Encodes a raw RGB565 image for UTFT drawSprite.
+
+The input is width*height pixels, two bytes each, high byte first, as the
+UTFT ImageConverter565 .raw files are (--little for low byte first). One
+color is taken as transparent; every row becomes runs of a skip byte, a
+count byte and count pixels, a count of 0 ends the row. The output is a C
+array in program memory, ready to include:
+
+    sprite565.py ship.raw 24 0xF81F ship > ship.h
+    ...
+    display.drawSprite(x, y, ship);
+"""
+
+import argparse
+import sys
+
+
+def encode(pixels, width, key):
+    height = len(pixels) // width
+    out = [height]
+
+    for row in range(height):
+        line = pixels[row*width:(row+1)*width]
+        col = 0
+        while col < width:
+            start = col
+            while col < width and line[col] == key:
+                col += 1
+            if col == width:
+                break
+            first = col
+            while col < width and line[col] != key:
+                col += 1
+            out += [first-start, col-first]
+            for p in line[first:col]:
+                out += [p >> 8, p & 0xff]
+        out += [0, 0]
+    return out
+
+
+def main():
+    ap = argparse.ArgumentParser(description="raw RGB565 to drawSprite runs")
+    ap.add_argument("raw", help="raw RGB565 image")
+    ap.add_argument("width", type=int, help="image width in pixels, 1-255")
+    ap.add_argument("key", type=lambda v: int(v, 0), help="transparent color, e.g. 0xF81F")
+    ap.add_argument("name", help="C name of the array")
+    ap.add_argument("--little", action="store_true", help="pixels are low byte first")
+    args = ap.parse_args()
+
+    data = open(args.raw, "rb").read()
+    if not 0 < args.width <= 255 or len(data) % (2*args.width):
+        sys.exit("width must be 1-255 and divide the image")
+    height = len(data) // (2*args.width)
+    if height > 255:
+        sys.exit("image is more than 255 rows high")
+
+    hi, lo = (1, 0) if args.little else (0, 1)
+    pixels = [data[i+hi] << 8 | data[i+lo] for i in range(0, len(data), 2)]
+    out = encode(pixels, args.width, args.key)
+
+    print("// %dx%d, transparent 0x%04X, %d bytes (%d as a bitmap)"
+          % (args.width, height, args.key, len(out), len(data)))
+    print("const uint8_t %s[] PROGMEM =\n{" % args.name)
+    for i in range(0, len(out), 16):
+        print("\t" + ", ".join("0x%02X" % b for b in out[i:i+16]) + ",")
+    print("};")
+
+
+if __name__ == "__main__":
+    main()